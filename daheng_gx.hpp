@@ -24,16 +24,60 @@
 #include <DxImageProc.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <new>
+#include <optional>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DMITIGR_GENICAM_X86 1
+#define DMITIGR_GENICAM_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define DMITIGR_GENICAM_X86 1
+#define DMITIGR_GENICAM_TARGET(isa)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define DMITIGR_GENICAM_TARGET(isa)
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #ifndef DMITIGR_GENICAM_DAHENG_GX_HPP
 #define DMITIGR_GENICAM_DAHENG_GX_HPP
@@ -109,11 +153,20 @@ inline void throw_if_last_error()
     throw Exception{code, str};
 }
 
+/**
+ * Calls the function `f` of GxIAPI.
+ *
+ * @throws Exception if `f` doesn't return `GX_STATUS_SUCCESS`. (The details
+ * are looked up by GXGetLastError() only in this case.)
+ */
 template<typename F, typename ... Types>
 inline auto call(F&& f, Types&& ... args)
 {
   auto result = f(std::forward<Types>(args)...);
-  throw_if_last_error();
+  if (result != GX_STATUS_SUCCESS) {
+    const auto [code, str] = get_last_error();
+    throw Exception{code != GX_STATUS_SUCCESS ? code : result, str};
+  }
   return result;
 }
 
@@ -429,697 +482,8942 @@ private:
 };
 
 // -----------------------------------------------------------------------------
-// Struct Frame_data
+// NUMA
 // -----------------------------------------------------------------------------
 
-struct Frame_data final {
-  ~Frame_data()
-  {
-    std::free(data.pImgBuf);
+/**
+ * @returns The NUMA node of the device denoted by the `path` in sysfs (for
+ * example, `/sys/bus/pci/devices/0000:3b:00.0`), or `-1` if unknown. The
+ * path is resolved and walked up until the `numa_node` attribute is found.
+ *
+ * @remarks Always returns `-1` on systems other than Linux.
+ */
+inline int numa_node_of_sysfs_device(const std::string& path)
+{
+#ifdef __linux__
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  for (auto p = fs::canonical(path, ec); !ec && p.has_relative_path();
+       p = p.parent_path()) {
+    if (std::ifstream attr{p / "numa_node"}) {
+      int result{-1};
+      return attr >> result ? result : -1;
+    }
   }
+#else
+  (void)path;
+#endif
+  return -1;
+}
 
-  Frame_data() = default;
+/**
+ * @returns The NUMA node of the PCI device of the given `address` (for
+ * example, `0000:3b:00.0`), or `-1` if unknown.
+ */
+inline int numa_node_of_pci_device(const std::string& address)
+{
+  return numa_node_of_sysfs_device("/sys/bus/pci/devices/" + address);
+}
 
-  Frame_data(GX_FRAME_DATA data) noexcept
-    : data{data}
-  {}
+/**
+ * @returns The NUMA node of the controller of the network interface of the
+ * given `name` (to which a GigE Vision device is connected), or `-1` if
+ * unknown.
+ */
+inline int numa_node_of_network_interface(const std::string& name)
+{
+  return numa_node_of_sysfs_device("/sys/class/net/" + name + "/device");
+}
 
-  Frame_data(const Frame_data&) = delete;
-  Frame_data& operator=(const Frame_data&) = delete;
+/**
+ * @returns The NUMA node of the host controller of the USB bus of the given
+ * `number` (to which a USB3 Vision device is connected), or `-1` if unknown.
+ */
+inline int numa_node_of_usb_bus(const unsigned number)
+{
+  return numa_node_of_sysfs_device("/sys/bus/usb/devices/usb" + std::to_string(number));
+}
 
-  Frame_data(Frame_data&& rhs) noexcept
-    : data{rhs.data}
-  {
-    rhs.data.pImgBuf = nullptr;
-  }
+/**
+ * @returns The CPUs of the NUMA `node`, or an empty vector if unknown.
+ *
+ * @remarks Always returns an empty vector on systems other than Linux.
+ */
+inline std::vector<int> numa_node_cpus(const int node)
+{
+  std::vector<int> result;
+#ifdef __linux__
+  if (node < 0)
+    return result;
 
-  Frame_data& operator=(Frame_data&& rhs) noexcept
-  {
-    if (this != &rhs) {
-      data = rhs.data;
-      rhs.data.pImgBuf = nullptr;
-    }
-    return *this;
+  // The format of cpulist is like "0-3,8-11".
+  std::ifstream attr{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+  for (int first{}; attr >> first;) {
+    int last{first};
+    if (attr.peek() == '-')
+      attr.ignore() >> last;
+    for (int cpu{first}; cpu <= last; ++cpu)
+      result.push_back(cpu);
+    if (attr.peek() == ',')
+      attr.ignore();
   }
+#else
+  (void)node;
+#endif
+  return result;
+}
 
-  GX_FRAME_DATA data{};
-};
+/**
+ * Pins the calling thread to the CPUs of the NUMA `node`.
+ *
+ * @returns `false` if the CPUs of the `node` are unknown (in particular, if
+ * `node < 0`), or `true` otherwise.
+ *
+ * @remarks Does nothing on systems other than Linux.
+ */
+inline bool pin_current_thread_to_numa_node(const int node)
+{
+#ifdef __linux__
+  const auto cpus = numa_node_cpus(node);
+  if (cpus.empty())
+    return false;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    if (cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+  }
+  if (const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+    throw std::system_error{err, std::system_category(), "pthread_setaffinity_np()"};
+  return true;
+#else
+  (void)node;
+  return false;
+#endif
+}
 
-// -----------------------------------------------------------------------------
-// Class Device
-// -----------------------------------------------------------------------------
+/**
+ * Sets the preferred NUMA `node` of the page-aligned memory range of the
+ * given `length` starting at `address`. The pages which are already touched
+ * are migrated.
+ *
+ * @returns `true` on success, or `false` otherwise.
+ *
+ * @remarks Does nothing on systems other than Linux.
+ */
+inline bool numa_bind(void* const address, const std::size_t length,
+  const int node) noexcept
+{
+#ifdef __linux__
+  constexpr int mpol_preferred{1};
+  constexpr unsigned mpol_mf_move{1 << 1};
+  constexpr std::size_t max_node{1024};
+  constexpr std::size_t bits{sizeof(unsigned long) * 8};
+  if (node < 0 || static_cast<std::size_t>(node) >= max_node)
+    return false;
+
+  unsigned long mask[max_node / bits]{};
+  mask[node / bits] = 1ul << (node % bits);
+  return !syscall(SYS_mbind, address, length, mpol_preferred, mask,
+    max_node + 1, mpol_mf_move);
+#else
+  (void)address;
+  (void)length;
+  (void)node;
+  return false;
+#endif
+}
 
-class Device final {
+/**
+ * The memory resource which allocates buffers preferably placed on the NUMA
+ * node.
+ *
+ * If the node is specified each buffer is mapped as whole pages of its own,
+ * so the placement policy never affects the memory of other allocations.
+ * Thus, the resource is intended for the large long-living buffers (such as
+ * the frame buffers) rather than for the small objects.
+ *
+ * @see numa_memory_resource().
+ */
+class Numa_memory_resource final : public std::pmr::memory_resource {
 public:
-  /// The destructor.
-  ~Device()
-  {
-    close_nothrow();
-  }
-
-  /// Non copy-constructible.
-  Device(const Device&) = delete;
-  /// Non copy-assignable.
-  Device& operator=(const Device&) = delete;
+  /**
+   * The constructor.
+   *
+   * @param node The NUMA node, or `-1` to allocate without any placement
+   * policy.
+   */
+  explicit Numa_memory_resource(const int node = -1) noexcept
+    : node_{node < 0 ? -1 : node}
+  {}
 
-  /// Move-constructible.
-  Device(Device&& rhs) noexcept
-    : handle_{rhs.handle_}
+  /// @returns The NUMA node.
+  int numa_node() const noexcept
   {
-    rhs.handle_ = {};
+    return node_;
   }
 
-  /// Move-assignable.
-  Device& operator=(Device&& rhs) noexcept
-  {
-    if (this != &rhs) {
-      Device tmp{std::move(rhs)};
-      swap(tmp);
-    }
-    return *this;
-  }
+private:
+  int node_{-1};
 
-  /// The swap operation.
-  void swap(Device& other) noexcept
+  static std::size_t page_size() noexcept
   {
-    std::swap(handle_, other.handle_);
+#ifdef __linux__
+    static const auto result = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return result;
+#else
+    return 4096;
+#endif
   }
 
-  /// The constructor.
-  explicit Device(GX_DEV_HANDLE handle = {})
-    : handle_{handle}
-  {}
-
-  /// Opens the device by index, starting from 1.
-  explicit Device(const std::uint32_t index)
+  static std::size_t page_length(const std::size_t bytes) noexcept
   {
-    call(GXOpenDeviceByIndex, index, &handle_);
+    return (std::max<std::size_t>(bytes, 1) + page_size() - 1)
+      / page_size() * page_size();
   }
 
   /**
-   * Opens the device by a specific unique identification,
-   * such as: SN, IP, MAC, Index etc.
+   * @returns The buffer of `bytes` rounded up to the page size if the node is
+   * specified, so that the whole mapping is bound to the node.
+   *
+   * @throws `std::bad_alloc` if `alignment` is greater than the page size
+   * when the node is specified.
    */
-  explicit Device(GX_OPEN_PARAM* const open_param)
+  void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
   {
-    call(GXOpenDevice, open_param, &handle_);
+#ifdef __linux__
+    if (node_ >= 0) {
+      if (alignment > page_size())
+        throw std::bad_alloc{};
+
+      const auto length = page_length(bytes);
+      void* const result = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (result == MAP_FAILED)
+        throw std::bad_alloc{};
+      numa_bind(result, length, node_);
+      return result;
+    }
+#endif
+    return ::operator new(bytes, std::align_val_t{alignment});
   }
 
-  /// @overload
-  explicit Device(const Open_param& open_param)
-    : Device{&open_param.handle_}
-  {}
-
-  /// @returns The underlying handle.
-  GX_DEV_HANDLE handle() noexcept
+  void do_deallocate(void* const p, const std::size_t bytes,
+    const std::size_t alignment) override
   {
-    return handle_;
+#ifdef __linux__
+    if (node_ >= 0) {
+      munmap(p, page_length(bytes));
+      return;
+    }
+#endif
+    ::operator delete(p, bytes, std::align_val_t{alignment});
   }
 
-  /// @overload
-  const GX_DEV_HANDLE handle() const noexcept
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
   {
-    return handle_;
+    const auto* const rhs = dynamic_cast<const Numa_memory_resource*>(&other);
+    return rhs && rhs->node_ == node_;
   }
+};
 
-  /// @returns `true` if this object keeps handle, or `false` otherwise.
-  explicit operator bool() const noexcept
-  {
-    return handle_;
-  }
+/**
+ * @returns The memory resource of the NUMA `node` (or the one without any
+ * placement policy if `node < 0`).
+ *
+ * @remarks The returned resources are never destroyed, so they are safe to
+ * use with buffers of any lifetime.
+ */
+inline std::pmr::memory_resource* numa_memory_resource(const int node)
+{
+  static std::mutex mutex;
+  static auto* const resources = new std::unordered_map<int,
+    std::unique_ptr<Numa_memory_resource>>;
+  const auto key = node < 0 ? -1 : node;
+  const std::lock_guard lg{mutex};
+  auto& result = (*resources)[key];
+  if (!result)
+    result = std::make_unique<Numa_memory_resource>(key);
+  return result.get();
+}
 
-  /// @returns The released handle.
-  GX_DEV_HANDLE release() noexcept
-  {
-    auto result = handle_;
-    handle_ = {};
-    return result;
-  }
+// -----------------------------------------------------------------------------
+// Class Huge_page_arena
+// -----------------------------------------------------------------------------
 
-  /// Closes the device.
-  void close()
+/**
+ * An arena of buffers backed by huge pages (as the memory resource).
+ *
+ * Each buffer is mapped with `MAP_HUGETLB` first. If there are no huge pages
+ * reserved in the system, the buffer is mapped with regular pages aligned
+ * to the huge page boundary and advised to be backed by transparent huge
+ * pages. Released buffers are kept for reuse, so the expensive mappings and
+ * page faults are paid only once per buffer.
+ *
+ * @warning The arena must outlive all the buffers allocated from it.
+ *
+ * @remarks Thread-safe. On systems other than Linux buffers are allocated
+ * by the aligned `operator new`.
+ */
+class Huge_page_arena final : public std::pmr::memory_resource {
+public:
+  /// The counters of allocations.
+  struct Stats final {
+    /// The number of buffers mapped with `MAP_HUGETLB` (backed by 2 MiB pages).
+    std::uint64_t huge_pages{};
+    /**
+     * The number of buffers successfully advised (`MADV_HUGEPAGE`) to be backed
+     * by transparent huge pages. This is not the number of buffers actually
+     * backed by them: that is decided by the kernel when the pages are faulted
+     * in (see `AnonHugePages` in `/proc/self/smaps`).
+     */
+    std::uint64_t advised_huge_pages{};
+    /// The number of buffers which got regular pages only.
+    std::uint64_t regular_pages{};
+    /// The number of allocations served by the released buffers.
+    std::uint64_t reused{};
+  };
+
+  /// The destructor. Unmaps the released buffers.
+  ~Huge_page_arena()
   {
-    call(GXStreamOff, handle_);
-    call(GXUnregisterCaptureCallback, handle_);
-    call(GXCloseDevice, handle_);
-    handle_ = {};
+    for (const auto& block : free_)
+      unmap(block);
   }
 
   /**
-   * @brief Restores the device to the initial state and the device is powered
-   * on again.
+   * The constructor.
    *
-   * After the call is completed, the host will lose its connection to the device.
-   * And because the interface can be set only when the device is open, the device
-   * will be closed in order to release the corresponding memory resources.
+   * @param numa_node The preferred NUMA node of buffers, or `-1`.
+   * @param max_free_buffers The maximum number of released buffers to keep
+   * for reuse.
    */
-  void reset()
-  {
-    /// Caution! Don't call close() after sending the reset, since GXStreamOff() will fail!
-    call(GXSendCommand, handle_, GX_COMMAND_DEVICE_RESET);
-    call(GXCloseDevice, handle_);
-    handle_ = {};
-  }
+  explicit Huge_page_arena(const int numa_node = -1,
+    const std::size_t max_free_buffers = 16)
+    : numa_node_{numa_node}
+    , max_free_buffers_{max_free_buffers}
+  {}
+
+  /// Non copy-constructible.
+  Huge_page_arena(const Huge_page_arena&) = delete;
+  /// Non copy-assignable.
+  Huge_page_arena& operator=(const Huge_page_arena&) = delete;
+  /// Non move-constructible.
+  Huge_page_arena(Huge_page_arena&&) = delete;
+  /// Non move-assignable.
+  Huge_page_arena& operator=(Huge_page_arena&&) = delete;
 
   /**
-   * Closes the device.
-   *
-   * @returns `true` on success, or `false` otherwise.
+   * The size of the huge page used by the arena. (Requested explicitly with
+   * `MAP_HUGE_2MB` rather than the default size of the system, which could
+   * be different.)
    */
-  bool close_nothrow() noexcept
-  {
-    if (handle_) {
-      auto s = GXStreamOff(handle_);
-      s |= GXUnregisterCaptureCallback(handle_);
-      s |= GXCloseDevice(handle_);
-      handle_ = {};
-      return (s == GX_STATUS_SUCCESS);
-    } else
-      return true;
-  }
+  static constexpr std::size_t huge_page_size{2 * 1024 * 1024};
 
-  /// @name Device information
-  /// @{
-
-  bool is_device_link_throughput_limit_mode_implemented() const
+  /// @returns The counters.
+  Stats stats() const
   {
-    return is_implemented(GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE);
+    const std::lock_guard lg{mutex_};
+    return stats_;
   }
 
-  void set_device_link_throughput_limit_mode(const GX_DEVICE_LINK_THROUGHPUT_LIMIT_MODE_ENTRY value)
+  /// @returns The preferred NUMA node of buffers.
+  int numa_node() const noexcept
   {
-    set_enum(GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE, value);
+    return numa_node_;
   }
 
-  auto device_link_throughput_limit_mode() const
+private:
+  struct Block final {
+    void* address{};
+    std::size_t length{};
+  };
+
+  int numa_node_{-1};
+  std::size_t max_free_buffers_{};
+  mutable std::mutex mutex_;
+  std::unordered_map<void*, Block> used_;
+  std::vector<Block> free_;
+  Stats stats_;
+
+  /**
+   * @returns The buffer of at least `size` bytes aligned to the huge page
+   * boundary.
+   */
+  void* do_allocate(const std::size_t size, const std::size_t alignment) override
   {
-    return static_cast<GX_DEVICE_LINK_THROUGHPUT_LIMIT_MODE_ENTRY>(get_enum(GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE));
+    if (alignment > huge_page_size)
+      throw std::bad_alloc{};
+
+    const auto length = (std::max<std::size_t>(size, 1) + huge_page_size - 1)
+      / huge_page_size * huge_page_size;
+    const std::lock_guard lg{mutex_};
+    // Reuse the smallest released buffer that fits without wasting too much.
+    auto best = free_.end();
+    for (auto i = free_.begin(); i != free_.end(); ++i) {
+      if (i->length >= length && i->length <= 2 * length &&
+        (best == free_.end() || i->length < best->length))
+        best = i;
+    }
+    Block block;
+    if (best != free_.end()) {
+      block = *best;
+      *best = free_.back();
+      free_.pop_back();
+      stats_.reused++;
+    } else
+      block = map(length);
+    used_.emplace(block.address, block);
+    return block.address;
   }
 
-  bool is_timestamp_tick_frequency_implemented() const
+  void do_deallocate(void* const buffer, std::size_t, std::size_t) override
   {
-    return is_implemented(GX_INT_TIMESTAMP_TICK_FREQUENCY);
+    const std::lock_guard lg{mutex_};
+    if (const auto i = used_.find(buffer); i != used_.end()) {
+      const auto block = i->second;
+      used_.erase(i);
+      if (free_.size() < max_free_buffers_)
+        free_.push_back(block);
+      else
+        unmap(block);
+    }
   }
 
-  int timestamp_tick_frequency() const
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
   {
-    return get_int(GX_INT_TIMESTAMP_TICK_FREQUENCY);
+    return this == &other;
   }
 
-  bool is_timestamp_latch_value_implemented() const
+  Block map(const std::size_t length)
   {
-    return is_implemented(GX_INT_TIMESTAMP_LATCH_VALUE);
+#ifdef __linux__
+    constexpr int prot{PROT_READ | PROT_WRITE};
+    constexpr int flags{MAP_PRIVATE | MAP_ANONYMOUS};
+    constexpr int huge_flags{MAP_HUGETLB | 21 << MAP_HUGE_SHIFT}; // MAP_HUGE_2MB
+    static_assert(std::size_t{1} << 21 == huge_page_size);
+    if (void* const p = mmap(nullptr, length, prot, flags | huge_flags, -1, 0);
+      p != MAP_FAILED) {
+      numa_bind(p, length, numa_node_);
+      stats_.huge_pages++;
+      return {p, length};
+    }
+
+    // Over-map to align to the huge page boundary, then trim the excess.
+    const auto raw_length = length + huge_page_size;
+    void* const raw = mmap(nullptr, raw_length, prot, flags, -1, 0);
+    if (raw == MAP_FAILED)
+      throw std::bad_alloc{};
+    const auto raw_begin = reinterpret_cast<std::uintptr_t>(raw);
+    const auto begin = (raw_begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+    if (const auto head = begin - raw_begin)
+      munmap(raw, head);
+    if (const auto tail = raw_begin + raw_length - (begin + length))
+      munmap(reinterpret_cast<void*>(begin + length), tail);
+
+    void* const p = reinterpret_cast<void*>(begin);
+    numa_bind(p, length, numa_node_);
+    if (!madvise(p, length, MADV_HUGEPAGE))
+      stats_.advised_huge_pages++;
+    else
+      stats_.regular_pages++;
+    return {p, length};
+#else
+    void* const p = ::operator new(length, std::align_val_t{huge_page_size});
+    stats_.regular_pages++;
+    return {p, length};
+#endif
   }
 
-  int timestamp_latch_value() const
+  static void unmap(const Block& block) noexcept
   {
-    return get_int(GX_INT_TIMESTAMP_LATCH_VALUE);
+#ifdef __linux__
+    munmap(block.address, block.length);
+#else
+    ::operator delete(block.address, std::align_val_t{huge_page_size});
+#endif
   }
+};
 
-  bool is_latch_timestamp_implemented() const
+// -----------------------------------------------------------------------------
+// Struct Frame_data
+// -----------------------------------------------------------------------------
+
+/**
+ * A frame with the image buffer it owns.
+ *
+ * The buffer is allocated from the memory resource which is used to release
+ * it. If the memory resource is not set (for example, when constructed from
+ * `GX_FRAME_DATA`), the buffer is released by `std::free()`.
+ */
+struct Frame_data final {
+  /// The alignment of the buffers allocated by Frame_data.
+  static constexpr std::size_t alignment{64};
+
+  /// The destructor. Releases the image buffer.
+  ~Frame_data()
   {
-    return is_implemented(GX_COMMAND_TIMESTAMP_LATCH);
+    if (resource)
+      resource->deallocate(data.pImgBuf, capacity, alignment);
+    else
+      std::free(data.pImgBuf);
   }
 
+  /// Constructs an instance without image buffer.
+  Frame_data() = default;
+
+  /// Constructs an instance which takes the ownership of `data.pImgBuf`.
+  Frame_data(GX_FRAME_DATA data) noexcept
+    : data{data}
+  {}
+
   /**
-   * Latchs the current timestamp value, that is, the time value taken from the
-   * start of the device power-on to the call of the timestamp latch command. The
-   * time value needs to be read through the `timestamp_latch_value()`.
+   * Constructs an instance with the image buffer of the given `capacity`
+   * allocated from the `resource`.
    *
-   * @see timestamp_latch_value().
+   * @param capacity The size of the image buffer.
+   * @param resource The memory resource. If `nullptr`, the resource returned
+   * by `numa_memory_resource(-1)` is used.
    */
-  void latch_timestamp()
+  Frame_data(const std::size_t capacity, std::pmr::memory_resource* resource)
+    : resource{resource ? resource : numa_memory_resource(-1)}
+    , capacity{std::max<std::size_t>(capacity, 1)}
   {
-    call(GXSendCommand, handle_, GX_COMMAND_TIMESTAMP_LATCH);
+    data.pImgBuf = this->resource->allocate(this->capacity, alignment);
   }
 
-  bool is_reset_timestamp_implemented() const
+  Frame_data(const Frame_data&) = delete;
+  Frame_data& operator=(const Frame_data&) = delete;
+
+  Frame_data(Frame_data&& rhs) noexcept
+    : data{rhs.data}
+    , resource{rhs.resource}
+    , capacity{rhs.capacity}
   {
-    return is_implemented(GX_COMMAND_TIMESTAMP_RESET);
+    rhs.data.pImgBuf = nullptr;
+    rhs.resource = {};
+    rhs.capacity = {};
   }
 
-  /// Resets the timestamp counter and recount from zero.
-  void reset_timestamp()
+  Frame_data& operator=(Frame_data&& rhs) noexcept
   {
-    call(GXSendCommand, handle_, GX_COMMAND_TIMESTAMP_RESET);
+    if (this != &rhs) {
+      Frame_data tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
   }
 
-  bool is_latch_reset_timestamp_implemented() const
+  /// The swap operation.
+  void swap(Frame_data& other) noexcept
+  {
+    using std::swap;
+    swap(data, other.data);
+    swap(resource, other.resource);
+    swap(capacity, other.capacity);
+  }
+
+  GX_FRAME_DATA data{};
+
+  /// The memory resource of the image buffer.
+  std::pmr::memory_resource* resource{};
+
+  /// The size of the image buffer allocated from the `resource`.
+  std::size_t capacity{};
+};
+
+// -----------------------------------------------------------------------------
+// Struct Time_base
+// -----------------------------------------------------------------------------
+
+/**
+ * A correlation between the timestamps of a device and a common time base
+ * (which is usually the host's `std::chrono::steady_clock`).
+ *
+ * @see Device::time_base().
+ */
+struct Time_base final {
+  /// Device timestamp at the correlation point, in ticks.
+  std::uint64_t ticks{};
+
+  /// Device timestamp tick frequency, in Hz.
+  std::uint64_t tick_frequency{1'000'000'000};
+
+  /// Common time at the correlation point, in nanoseconds.
+  std::int64_t nanoseconds{};
+
+  /// @returns The device `timestamp` converted to the common time base.
+  std::int64_t to_nanoseconds(const std::uint64_t timestamp) const noexcept
+  {
+    constexpr std::int64_t nano{1'000'000'000};
+    const auto freq = static_cast<std::int64_t>(tick_frequency);
+    const auto delta = static_cast<std::int64_t>(timestamp - ticks);
+    // Split to avoid the overflow of `delta * nano`.
+    return nanoseconds + delta / freq * nano + delta % freq * nano / freq;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Device events
+// -----------------------------------------------------------------------------
+
+/// An event of the device event channel.
+enum class Event {
+  /// The end of exposure of a frame.
+  exposure_end = 0,
+  /// A block of image data is discarded.
+  block_discard = 1,
+  /// The event queue of the device is overrun.
+  event_overrun = 2,
+  /// The frame start trigger is ignored since the device isn't ready.
+  frame_start_overtrigger = 3,
+  /// The frame memory of the device is not empty.
+  block_not_empty = 4,
+  /// The internal error of the device.
+  internal_error = 5
+};
+
+/// The number of values of Event.
+constexpr std::size_t event_count{6};
+
+/// @returns The string representation of the `event`.
+constexpr const char* to_literal(const Event event) noexcept
+{
+  switch (event) {
+  case Event::exposure_end: return "exposure_end";
+  case Event::block_discard: return "block_discard";
+  case Event::event_overrun: return "event_overrun";
+  case Event::frame_start_overtrigger: return "frame_start_overtrigger";
+  case Event::block_not_empty: return "block_not_empty";
+  case Event::internal_error: return "internal_error";
+  }
+  return "unknown";
+}
+
+/// The features of the event.
+struct Event_features final {
+  /// The value of `GX_ENUM_EVENT_SELECTOR`.
+  std::int64_t selector{};
+  /// The feature which is signaled when the event arrives.
+  GX_FEATURE_ID id{};
+  /// The feature of the timestamp of the event.
+  GX_FEATURE_ID timestamp{};
+  /// The feature of the frame ID of the event, or `0` if not available.
+  GX_FEATURE_ID frame_id{};
+};
+
+/// @returns The features of the `event`.
+constexpr Event_features event_features(const Event event) noexcept
+{
+  switch (event) {
+  case Event::exposure_end:
+    return {GX_ENUM_EVENT_SELECTOR_EXPOSUREEND, GX_INT_EVENT_EXPOSUREEND,
+      GX_INT_EVENT_EXPOSUREEND_TIMESTAMP, GX_INT_EVENT_EXPOSUREEND_FRAMEID};
+  case Event::block_discard:
+    return {GX_ENUM_EVENT_SELECTOR_BLOCK_DISCARD, GX_INT_EVENT_BLOCK_DISCARD,
+      GX_INT_EVENT_BLOCK_DISCARD_TIMESTAMP, {}};
+  case Event::event_overrun:
+    return {GX_ENUM_EVENT_SELECTOR_EVENT_OVERRUN, GX_INT_EVENT_OVERRUN,
+      GX_INT_EVENT_OVERRUN_TIMESTAMP, {}};
+  case Event::frame_start_overtrigger:
+    return {GX_ENUM_EVENT_SELECTOR_FRAMESTART_OVERTRIGGER, GX_INT_EVENT_FRAMESTART_OVERTRIGGER,
+      GX_INT_EVENT_FRAMESTART_OVERTRIGGER_TIMESTAMP, {}};
+  case Event::block_not_empty:
+    return {GX_ENUM_EVENT_SELECTOR_BLOCK_NOT_EMPTY, GX_INT_EVENT_BLOCK_NOT_EMPTY,
+      GX_INT_EVENT_BLOCK_NOT_EMPTY_TIMESTAMP, {}};
+  case Event::internal_error:
+    return {GX_ENUM_EVENT_SELECTOR_INTERNAL_ERROR, GX_INT_EVENT_INTERNAL_ERROR,
+      GX_INT_EVENT_INTERNAL_ERROR_TIMESTAMP, {}};
+  }
+  return {};
+}
+
+/// The data of the event passed to the event callback.
+struct Event_data final {
+  /// The event.
+  Event event{};
+  /// The timestamp of the event (in ticks of the device), or `0` if unknown.
+  std::uint64_t timestamp{};
+  /// The ID of the frame of the event, or `0` if not available.
+  std::uint64_t frame_id{};
+  /**
+   * The time from the event (on the device) to the call of the callback (on
+   * the host), in nanoseconds, or `0` if unknown.
+   */
+  std::int64_t latency{};
+};
+
+/**
+ * The event callback.
+ *
+ * @param data The user data passed to Device::register_event_callback().
+ */
+using Event_callback = void(*)(const Event_data& event, void* data);
+
+/// The statistics of the latency from events to calls of the callback.
+struct Event_latency final {
+  /// The number of measurements.
+  std::uint64_t count{};
+  /// The minimum latency, in nanoseconds.
+  std::int64_t min{};
+  /// The maximum latency, in nanoseconds.
+  std::int64_t max{};
+  /// The sum of latencies, in nanoseconds.
+  std::int64_t sum{};
+
+  /// @returns The mean latency, in nanoseconds.
+  double mean() const noexcept
+  {
+    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Feature registry
+// -----------------------------------------------------------------------------
+
+/// @returns The type of the `feature` (which is encoded in its ID).
+constexpr GX_FEATURE_TYPE feature_type(const GX_FEATURE_ID feature) noexcept
+{
+  return static_cast<GX_FEATURE_TYPE>(static_cast<std::uint32_t>(feature) & 0xf0000000);
+}
+
+/**
+ * The value of a feature: `std::int64_t` for integer and enumeration
+ * features, `double` for float features, `bool` for boolean features, and
+ * `std::string` for string features.
+ */
+using Feature_value = std::variant<std::int64_t, double, bool, std::string>;
+
+/// The result of reading of the feature by Device::read_features().
+struct Feature_read final {
+  /// The ID of the feature to read.
+  GX_FEATURE_ID id{};
+  /// The status of reading.
+  GX_STATUS status{GX_STATUS_SUCCESS};
+  /// The value, which is meaningful only if `status == GX_STATUS_SUCCESS`.
+  Feature_value value{};
+};
+
+/**
+ * The callback of the feature change.
+ *
+ * @param change The feature and its new value (read just before the call).
+ * @param data The user data passed to Device::register_feature_callback().
+ */
+using Feature_callback = void(*)(const Feature_read& change, void* data);
+
+/// The information about the feature.
+struct Feature_info final {
+  /// The GenICam name of the feature.
+  std::string_view name;
+  /// The ID of the feature.
+  GX_FEATURE_ID id{};
+
+  /// @returns The type of the feature.
+  constexpr GX_FEATURE_TYPE type() const noexcept
+  {
+    return feature_type(id);
+  }
+};
+
+/// The features known by name.
+inline constexpr Feature_info feature_infos[]{
+  {"DeviceVendorName", GX_STRING_DEVICE_VENDOR_NAME},
+  {"DeviceModelName", GX_STRING_DEVICE_MODEL_NAME},
+  {"DeviceFirmwareVersion", GX_STRING_DEVICE_FIRMWARE_VERSION},
+  {"DeviceVersion", GX_STRING_DEVICE_VERSION},
+  {"DeviceSerialNumber", GX_STRING_DEVICE_SERIAL_NUMBER},
+  {"FactorySettingVersion", GX_STRING_FACTORY_SETTING_VERSION},
+  {"DeviceUserID", GX_STRING_DEVICE_USERID},
+  {"DeviceLinkSelector", GX_INT_DEVICE_LINK_SELECTOR},
+  {"DeviceLinkThroughputLimitMode", GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE},
+  {"DeviceLinkThroughputLimit", GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT},
+  {"DeviceLinkCurrentThroughput", GX_INT_DEVICE_LINK_CURRENT_THROUGHPUT},
+  {"DeviceReset", GX_COMMAND_DEVICE_RESET},
+  {"TimestampTickFrequency", GX_INT_TIMESTAMP_TICK_FREQUENCY},
+  {"TimestampLatch", GX_COMMAND_TIMESTAMP_LATCH},
+  {"TimestampReset", GX_COMMAND_TIMESTAMP_RESET},
+  {"TimestampLatchReset", GX_COMMAND_TIMESTAMP_LATCH_RESET},
+  {"TimestampLatchValue", GX_INT_TIMESTAMP_LATCH_VALUE},
+  {"DeviceTemperatureSelector", GX_ENUM_DEVICE_TEMPERATURE_SELECTOR},
+  {"DeviceTemperature", GX_FLOAT_DEVICE_TEMPERATURE},
+  {"SensorWidth", GX_INT_SENSOR_WIDTH},
+  {"SensorHeight", GX_INT_SENSOR_HEIGHT},
+  {"WidthMax", GX_INT_WIDTH_MAX},
+  {"HeightMax", GX_INT_HEIGHT_MAX},
+  {"OffsetX", GX_INT_OFFSET_X},
+  {"OffsetY", GX_INT_OFFSET_Y},
+  {"Width", GX_INT_WIDTH},
+  {"Height", GX_INT_HEIGHT},
+  {"BinningHorizontal", GX_INT_BINNING_HORIZONTAL},
+  {"BinningVertical", GX_INT_BINNING_VERTICAL},
+  {"DecimationHorizontal", GX_INT_DECIMATION_HORIZONTAL},
+  {"DecimationVertical", GX_INT_DECIMATION_VERTICAL},
+  {"PixelSize", GX_ENUM_PIXEL_SIZE},
+  {"PixelColorFilter", GX_ENUM_PIXEL_COLOR_FILTER},
+  {"PixelFormat", GX_ENUM_PIXEL_FORMAT},
+  {"ReverseX", GX_BOOL_REVERSE_X},
+  {"ReverseY", GX_BOOL_REVERSE_Y},
+  {"TestPattern", GX_ENUM_TEST_PATTERN},
+  {"PayloadSize", GX_INT_PAYLOAD_SIZE},
+  {"AcquisitionMode", GX_ENUM_ACQUISITION_MODE},
+  {"AcquisitionStart", GX_COMMAND_ACQUISITION_START},
+  {"AcquisitionStop", GX_COMMAND_ACQUISITION_STOP},
+  {"TriggerMode", GX_ENUM_TRIGGER_MODE},
+  {"TriggerSoftware", GX_COMMAND_TRIGGER_SOFTWARE},
+  {"TriggerActivation", GX_ENUM_TRIGGER_ACTIVATION},
+  {"TriggerSwitch", GX_ENUM_TRIGGER_SWITCH},
+  {"ExposureTime", GX_FLOAT_EXPOSURE_TIME},
+  {"ExposureAuto", GX_ENUM_EXPOSURE_AUTO},
+  {"TriggerFilterRaisingEdge", GX_FLOAT_TRIGGER_FILTER_RAISING},
+  {"TriggerFilterFallingEdge", GX_FLOAT_TRIGGER_FILTER_FALLING},
+  {"TriggerSource", GX_ENUM_TRIGGER_SOURCE},
+  {"ExposureMode", GX_ENUM_EXPOSURE_MODE},
+  {"TriggerSelector", GX_ENUM_TRIGGER_SELECTOR},
+  {"TriggerDelay", GX_FLOAT_TRIGGER_DELAY},
+  {"ExposureDelay", GX_FLOAT_EXPOSURE_DELAY},
+  {"AcquisitionFrameRate", GX_FLOAT_ACQUISITION_FRAME_RATE},
+  {"AcquisitionFrameRateMode", GX_ENUM_ACQUISITION_FRAME_RATE_MODE},
+  {"CurrentAcquisitionFrameRate", GX_FLOAT_CURRENT_ACQUISITION_FRAME_RATE},
+  {"GainSelector", GX_ENUM_GAIN_SELECTOR},
+  {"Gain", GX_FLOAT_GAIN},
+  {"GainAuto", GX_ENUM_GAIN_AUTO},
+  {"BlackLevelSelector", GX_ENUM_BLACKLEVEL_SELECTOR},
+  {"BlackLevel", GX_FLOAT_BLACKLEVEL},
+  {"BlackLevelAuto", GX_ENUM_BLACKLEVEL_AUTO},
+  {"BalanceRatioSelector", GX_ENUM_BALANCE_RATIO_SELECTOR},
+  {"BalanceRatio", GX_FLOAT_BALANCE_RATIO},
+  {"BalanceWhiteAuto", GX_ENUM_BALANCE_WHITE_AUTO},
+  {"Gamma", GX_FLOAT_GAMMA},
+  {"GammaEnable", GX_BOOL_GAMMA_ENABLE},
+  {"EventSelector", GX_ENUM_EVENT_SELECTOR},
+  {"EventNotification", GX_ENUM_EVENT_NOTIFICATION},
+  {"EventExposureEnd", GX_INT_EVENT_EXPOSUREEND},
+  {"EventExposureEndTimestamp", GX_INT_EVENT_EXPOSUREEND_TIMESTAMP},
+  {"EventExposureEndFrameID", GX_INT_EVENT_EXPOSUREEND_FRAMEID},
+  {"ChunkModeActive", GX_BOOL_CHUNKMODE_ACTIVE},
+  {"ChunkSelector", GX_ENUM_CHUNK_SELECTOR},
+  {"ChunkEnable", GX_BOOL_CHUNK_ENABLE},
+  {"StreamAnnouncedBufferCount", GX_DS_INT_ANNOUNCED_BUFFER_COUNT},
+  {"StreamDeliveredFrameCount", GX_DS_INT_DELIVERED_FRAME_COUNT},
+  {"StreamLostFrameCount", GX_DS_INT_LOST_FRAME_COUNT},
+  {"StreamIncompleteFrameCount", GX_DS_INT_INCOMPLETE_FRAME_COUNT},
+  {"StreamDeliveredPacketCount", GX_DS_INT_DELIVERED_PACKET_COUNT},
+  {"StreamResendPacketCount", GX_DS_INT_RESEND_PACKET_COUNT},
+  {"StreamTransferSize", GX_DS_INT_STREAM_TRANSFER_SIZE},
+  {"StreamTransferNumberUrb", GX_DS_INT_STREAM_TRANSFER_NUMBER_URB}
+};
+
+/**
+ * A perfect hash table of feature_infos built at compile time.
+ *
+ * @details The names are hashed once (FNV-1a) and distributed among buckets.
+ * Each bucket has the displacement which is mixed with the hash to place its
+ * names into distinct slots without collisions (the "hash and displace"
+ * method), so the lookup costs one hash of the name, one mix and one
+ * comparison of strings.
+ */
+class Feature_registry final {
+public:
+  /// The number of buckets.
+  static constexpr std::size_t bucket_count{32};
+
+  /// The number of slots.
+  static constexpr std::size_t slot_count{128};
+
+  /// The constructor. Fails to compile if the table can't be built.
+  constexpr Feature_registry()
+  {
+    constexpr std::size_t size{std::size(feature_infos)};
+    static_assert(size < slot_count);
+
+    std::array<std::size_t, bucket_count> sizes{};
+    for (std::size_t i{}; i < size; ++i)
+      sizes[bucket(hash(feature_infos[i].name))]++;
+
+    // Place the largest buckets first.
+    for (std::size_t n{size}; n > 0; --n) {
+      for (std::size_t b{}; b < bucket_count; ++b) {
+        if (sizes[b] != n)
+          continue;
+
+        for (std::uint32_t d{1};; ++d) {
+          if (d > 0xffff)
+            throw std::logic_error{"cannot build feature registry"};
+
+          std::array<std::size_t, size> placed{};
+          std::size_t count{};
+          for (std::size_t i{}; i < size; ++i) {
+            const auto h = hash(feature_infos[i].name);
+            if (bucket(h) != b)
+              continue;
+
+            const auto s = slot(h, d);
+            bool is_free{!slots_[s]};
+            for (std::size_t k{}; k < count; ++k)
+              is_free = is_free && placed[k] != s;
+            if (!is_free)
+              break;
+            placed[count++] = s;
+          }
+          if (count == n) {
+            for (std::size_t i{}, k{}; i < size; ++i) {
+              if (bucket(hash(feature_infos[i].name)) == b)
+                slots_[placed[k++]] = static_cast<std::uint8_t>(i + 1);
+            }
+            displacements_[b] = static_cast<std::uint16_t>(d);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  /// @returns The information about the feature of the given `name`, or `nullptr`.
+  constexpr const Feature_info* find(const std::string_view name) const noexcept
+  {
+    const auto h = hash(name);
+    const auto index = slots_[slot(h, displacements_[bucket(h)])];
+    if (!index)
+      return nullptr;
+
+    const auto& result = feature_infos[index - 1];
+    return result.name == name ? &result : nullptr;
+  }
+
+private:
+  std::array<std::uint16_t, bucket_count> displacements_{};
+  std::array<std::uint8_t, slot_count> slots_{}; // indices plus 1, or 0
+
+  static constexpr std::uint64_t hash(const std::string_view name) noexcept
+  {
+    std::uint64_t result{14695981039346656037ull};
+    for (const char c : name) {
+      result ^= static_cast<unsigned char>(c);
+      result *= 1099511628211ull;
+    }
+    return result;
+  }
+
+  static constexpr std::size_t bucket(const std::uint64_t hash) noexcept
+  {
+    return (hash >> 32) & (bucket_count - 1);
+  }
+
+  static constexpr std::size_t slot(std::uint64_t hash, const std::uint32_t displacement) noexcept
+  {
+    hash ^= displacement;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash & (slot_count - 1);
+  }
+};
+
+/// The registry of features known by name.
+inline constexpr Feature_registry feature_registry;
+
+/**
+ * @returns The information about the feature of the given `name`, or
+ * `nullptr` if the feature is unknown.
+ */
+constexpr const Feature_info* find_feature(const std::string_view name) noexcept
+{
+  return feature_registry.find(name);
+}
+
+/// The cache of Feature which caches nothing.
+struct No_feature_cache final {
+  /// Does nothing.
+  constexpr void invalidate() noexcept
+  {}
+};
+
+/**
+ * The cache of Feature which keeps the last value read or written, so the
+ * repeated reads of the feature which is changed only by the application
+ * (for example, the exposure time in the manual mode) cost nothing.
+ */
+template<typename T>
+class Feature_cache final {
+public:
+  /// The type of the cached value.
+  using Value = T;
+
+  /// @returns The cached value, or `std::nullopt` if nothing is cached.
+  const std::optional<T>& load() const noexcept
+  {
+    return value_;
+  }
+
+  /// Caches the `value`.
+  void store(const T& value)
+  {
+    value_ = value;
+  }
+
+  /// Drops the cached value.
+  void invalidate() noexcept
+  {
+    value_.reset();
+  }
+
+private:
+  std::optional<T> value_;
+};
+
+/**
+ * The type of the entries of the enumeration feature of the given ID.
+ *
+ * @remarks It's `std::int64_t` for the features which have no entry type in
+ * GxIAPI (or not specialized yet).
+ */
+template<GX_FEATURE_ID Id>
+struct Feature_entry final {
+  /// The type of the entries.
+  using Type = std::int64_t;
+};
+
+#define DMITIGR_GENICAM_FEATURE_ENTRY(id, type) \
+  template<> struct Feature_entry<id> final { using Type = type; }
+
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE,
+  GX_DEVICE_LINK_THROUGHPUT_LIMIT_MODE_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_PIXEL_FORMAT, GX_PIXEL_FORMAT_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_TRIGGER_MODE, GX_TRIGGER_MODE_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_TRIGGER_SOURCE, GX_TRIGGER_SOURCE_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_TRIGGER_SWITCH, GX_TRIGGER_SWITCH_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_EXPOSURE_MODE, GX_EXPOSURE_MODE_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_GAIN_SELECTOR, GX_GAIN_SELECTOR_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_BALANCE_RATIO_SELECTOR,
+  GX_BALANCE_RATIO_SELECTOR_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_CHUNK_SELECTOR, GX_CHUNK_SELECTOR_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_EVENT_SELECTOR, GX_EVENT_SELECTOR_ENTRY);
+DMITIGR_GENICAM_FEATURE_ENTRY(GX_ENUM_EVENT_NOTIFICATION,
+  GX_EVENT_NOTIFICATION_ENTRY);
+
+#undef DMITIGR_GENICAM_FEATURE_ENTRY
+
+// -----------------------------------------------------------------------------
+// Class Feature
+// -----------------------------------------------------------------------------
+
+class Device;
+
+/**
+ * A typed accessor of the feature of the given ID bound to a device.
+ *
+ * The type of the value is deduced from the type encoded in the ID:
+ * `std::int64_t` for integer features, `Feature_entry<Id>::Type` for
+ * enumeration features, `double` for float features, `bool` for boolean
+ * features, `std::string` for string features, and `void` for commands
+ * (which can only be executed).
+ *
+ * @par Example
+ * @code
+ * using Exposure_time = Feature<GX_FLOAT_EXPOSURE_TIME>;
+ * Exposure_time exposure_time{device};
+ * if (exposure_time.is_implemented())
+ *   exposure_time.set(std::clamp(1000., exposure_time.range().first,
+ *     exposure_time.range().second));
+ * @endcode
+ *
+ * @tparam Cache The cache of values: either No_feature_cache, or the class
+ * like `Feature_cache<Value>` which caches values of exactly the type
+ * `Value`. The cached value is returned by get() without reading the
+ * feature, and is updated by get() and set().
+ *
+ * @remarks The device must outlive the accessor.
+ */
+template<GX_FEATURE_ID Id, class Cache = No_feature_cache>
+class Feature final {
+public:
+  /// The ID of the feature.
+  static constexpr GX_FEATURE_ID id{Id};
+
+  /// The type of the feature.
+  static constexpr GX_FEATURE_TYPE type{feature_type(Id)};
+
+  static_assert(type == GX_FEATURE_INT || type == GX_FEATURE_ENUM ||
+    type == GX_FEATURE_FLOAT || type == GX_FEATURE_BOOL ||
+    type == GX_FEATURE_STRING || type == GX_FEATURE_COMMAND,
+    "unsupported feature type");
+
+  /// The type of the value of the feature.
+  using Value =
+    std::conditional_t<type == GX_FEATURE_INT, std::int64_t,
+    std::conditional_t<type == GX_FEATURE_ENUM, typename Feature_entry<Id>::Type,
+    std::conditional_t<type == GX_FEATURE_FLOAT, double,
+    std::conditional_t<type == GX_FEATURE_BOOL, bool,
+    std::conditional_t<type == GX_FEATURE_STRING, std::string, void>>>>>;
+
+  static_assert([]
+  {
+    if constexpr (std::is_same_v<Cache, No_feature_cache>)
+      return true;
+    else
+      return std::is_same_v<typename Cache::Value, Value>;
+  }(), "invalid feature cache");
+
+  /// The constructor.
+  explicit Feature(Device& device, Cache cache = {})
+    : device_{&device}
+    , cache_{std::move(cache)}
+  {}
+
+  /// @returns The device.
+  Device& device() const noexcept
+  {
+    return *device_;
+  }
+
+  /// @returns The cache.
+  Cache& cache() const noexcept
+  {
+    return cache_;
+  }
+
+  /// @returns `true` if the feature is implemented by the device.
+  bool is_implemented() const;
+
+  /**
+   * @returns The value of the feature.
+   *
+   * @par Requires
+   * The feature is not a command.
+   */
+  Value get() const;
+
+  /**
+   * Sets the `value` of the feature.
+   *
+   * @par Requires
+   * The feature is not a command.
+   */
+  void set(const std::conditional_t<std::is_void_v<Value>, std::monostate, Value>& value);
+
+  /// @returns The range `[min, max]` of values of the integer or float feature.
+  template<typename V = Value, typename = std::enable_if_t<std::is_same_v<V, Value> &&
+    (type == GX_FEATURE_INT || type == GX_FEATURE_FLOAT)>>
+  std::pair<V, V> range() const
+  {
+    return read_range(*device_);
+  }
+
+  /// Executes the command.
+  template<typename V = Value, typename = std::enable_if_t<std::is_same_v<V, Value> &&
+    std::is_void_v<V>>>
+  void execute();
+
+  /**
+   * @returns The value of the feature of the `device` (read without any
+   * cache).
+   *
+   * @par Requires
+   * The feature is not a command.
+   */
+  static Value read(const Device& device);
+
+  /// @returns The range `[min, max]` of values of the feature of the `device`.
+  template<typename V = Value, typename = std::enable_if_t<std::is_same_v<V, Value> &&
+    (type == GX_FEATURE_INT || type == GX_FEATURE_FLOAT)>>
+  static std::pair<V, V> read_range(const Device& device);
+
+private:
+  Device* device_{};
+  mutable Cache cache_;
+};
+
+// -----------------------------------------------------------------------------
+// Class Device
+// -----------------------------------------------------------------------------
+
+class Device final {
+public:
+  /// The destructor.
+  ~Device()
+  {
+    close_nothrow();
+  }
+
+  /// Non copy-constructible.
+  Device(const Device&) = delete;
+  /// Non copy-assignable.
+  Device& operator=(const Device&) = delete;
+
+  /// Move-constructible.
+  Device(Device&& rhs) noexcept
+    : handle_{rhs.handle_}
+    , numa_node_{rhs.numa_node_}
+    , memory_resource_{rhs.memory_resource_}
+    , capture_callback_{std::move(rhs.capture_callback_)}
+    , event_handlers_{std::move(rhs.event_handlers_)}
+    , feature_handlers_{std::move(rhs.feature_handlers_)}
+  {
+    rhs.handle_ = {};
+    rhs.numa_node_ = -1;
+    rhs.memory_resource_ = {};
+  }
+
+  /// Move-assignable.
+  Device& operator=(Device&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Device tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// The swap operation.
+  void swap(Device& other) noexcept
+  {
+    using std::swap;
+    swap(handle_, other.handle_);
+    swap(numa_node_, other.numa_node_);
+    swap(memory_resource_, other.memory_resource_);
+    swap(capture_callback_, other.capture_callback_);
+    swap(event_handlers_, other.event_handlers_);
+    swap(feature_handlers_, other.feature_handlers_);
+  }
+
+  /// The constructor.
+  explicit Device(GX_DEV_HANDLE handle = {})
+    : handle_{handle}
+  {}
+
+  /// Opens the device by index, starting from 1.
+  explicit Device(const std::uint32_t index)
+  {
+    call(GXOpenDeviceByIndex, index, &handle_);
+  }
+
+  /**
+   * Opens the device by a specific unique identification,
+   * such as: SN, IP, MAC, Index etc.
+   */
+  explicit Device(GX_OPEN_PARAM* const open_param)
+  {
+    call(GXOpenDevice, open_param, &handle_);
+  }
+
+  /// @overload
+  explicit Device(const Open_param& open_param)
+    : Device{&open_param.handle_}
+  {}
+
+  /// @returns The underlying handle.
+  GX_DEV_HANDLE handle() noexcept
+  {
+    return handle_;
+  }
+
+  /// @overload
+  const GX_DEV_HANDLE handle() const noexcept
+  {
+    return handle_;
+  }
+
+  /// @returns `true` if this object keeps handle, or `false` otherwise.
+  explicit operator bool() const noexcept
+  {
+    return handle_;
+  }
+
+  /// @returns The released handle.
+  GX_DEV_HANDLE release() noexcept
+  {
+    auto result = handle_;
+    handle_ = {};
+    return result;
+  }
+
+  /// Closes the device.
+  void close()
+  {
+    call(GXStreamOff, handle_);
+    call(GXUnregisterCaptureCallback, handle_);
+    unregister_feature_callbacks_nothrow();
+    call(GXCloseDevice, handle_);
+    handle_ = {};
+  }
+
+  /**
+   * @brief Restores the device to the initial state and the device is powered
+   * on again.
+   *
+   * After the call is completed, the host will lose its connection to the device.
+   * And because the interface can be set only when the device is open, the device
+   * will be closed in order to release the corresponding memory resources.
+   */
+  void reset()
+  {
+    /// Caution! Don't call close() after sending the reset, since GXStreamOff() will fail!
+    call(GXSendCommand, handle_, GX_COMMAND_DEVICE_RESET);
+    call(GXCloseDevice, handle_);
+    handle_ = {};
+  }
+
+  /**
+   * Closes the device.
+   *
+   * @returns `true` on success, or `false` otherwise.
+   */
+  bool close_nothrow() noexcept
+  {
+    if (handle_) {
+      auto s = GXStreamOff(handle_);
+      s |= GXUnregisterCaptureCallback(handle_);
+      unregister_feature_callbacks_nothrow();
+      s |= GXCloseDevice(handle_);
+      handle_ = {};
+      return (s == GX_STATUS_SUCCESS);
+    } else
+      return true;
+  }
+
+  /// @name Device information
+  /// @{
+
+  bool is_device_link_throughput_limit_mode_implemented() const
+  {
+    return is_implemented(GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE);
+  }
+
+  void set_device_link_throughput_limit_mode(const GX_DEVICE_LINK_THROUGHPUT_LIMIT_MODE_ENTRY value)
+  {
+    feature<GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE>().set(value);
+  }
+
+  auto device_link_throughput_limit_mode() const
+  {
+    return Feature<GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE>::read(*this);
+  }
+
+  bool is_timestamp_tick_frequency_implemented() const
+  {
+    return is_implemented(GX_INT_TIMESTAMP_TICK_FREQUENCY);
+  }
+
+  std::int64_t timestamp_tick_frequency() const
+  {
+    return Feature<GX_INT_TIMESTAMP_TICK_FREQUENCY>::read(*this);
+  }
+
+  bool is_timestamp_latch_value_implemented() const
+  {
+    return is_implemented(GX_INT_TIMESTAMP_LATCH_VALUE);
+  }
+
+  std::int64_t timestamp_latch_value() const
+  {
+    return Feature<GX_INT_TIMESTAMP_LATCH_VALUE>::read(*this);
+  }
+
+  bool is_latch_timestamp_implemented() const
+  {
+    return is_implemented(GX_COMMAND_TIMESTAMP_LATCH);
+  }
+
+  /**
+   * Latchs the current timestamp value, that is, the time value taken from the
+   * start of the device power-on to the call of the timestamp latch command. The
+   * time value needs to be read through the `timestamp_latch_value()`.
+   *
+   * @see timestamp_latch_value().
+   */
+  void latch_timestamp()
+  {
+    feature<GX_COMMAND_TIMESTAMP_LATCH>().execute();
+  }
+
+  bool is_reset_timestamp_implemented() const
+  {
+    return is_implemented(GX_COMMAND_TIMESTAMP_RESET);
+  }
+
+  /// Resets the timestamp counter and recount from zero.
+  void reset_timestamp()
+  {
+    feature<GX_COMMAND_TIMESTAMP_RESET>().execute();
+  }
+
+  bool is_latch_reset_timestamp_implemented() const
+  {
+    return is_implemented(GX_COMMAND_TIMESTAMP_LATCH_RESET);
+  }
+
+  /**
+   * First latchs the current timestamp value, then resets the timestamp
+   * counter and recounts from zero.
+   */
+  void latch_reset_timestamp()
+  {
+    feature<GX_COMMAND_TIMESTAMP_LATCH_RESET>().execute();
+  }
+
+  /**
+   * Latchs the current timestamp and correlates it with the host's
+   * `std::chrono::steady_clock`.
+   *
+   * @returns The time base to map the timestamps of the frames captured by
+   * this device to the host clock.
+   *
+   * @par Requires
+   * `is_latch_timestamp_implemented() && is_timestamp_latch_value_implemented()`.
+   *
+   * @see Time_base.
+   */
+  Time_base time_base()
+  {
+    const auto before = std::chrono::steady_clock::now();
+    latch_timestamp();
+    const auto after = std::chrono::steady_clock::now();
+    Time_base result;
+    result.ticks = static_cast<std::uint64_t>(timestamp_latch_value());
+    if (is_timestamp_tick_frequency_implemented())
+      result.tick_frequency = static_cast<std::uint64_t>(timestamp_tick_frequency());
+    result.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      (before + (after - before) / 2).time_since_epoch()).count();
+    return result;
+  }
+
+  /// @}
+
+  /// @name Image format
+  /// @{
+
+  bool is_pixel_format_implemented() const
+  {
+    return is_implemented(GX_ENUM_PIXEL_FORMAT);
+  }
+
+  void set_pixel_format(const GX_PIXEL_FORMAT_ENTRY value)
+  {
+    feature<GX_ENUM_PIXEL_FORMAT>().set(value);
+  }
+
+  GX_PIXEL_FORMAT_ENTRY pixel_format() const
+  {
+    return Feature<GX_ENUM_PIXEL_FORMAT>::read(*this);
+  }
+
+  /// @}
+
+  /// @name Transport layer
+  /// @{
+
+  /// @returns The number of bytes transferred for each image or chunk on the stream channel.
+  std::int64_t payload_size() const
+  {
+    return Feature<GX_INT_PAYLOAD_SIZE>::read(*this);
+  }
+
+  /// @}
+
+  /// @name Acquisition trigger
+  /// @{
+
+  bool is_trigger_mode_implemented() const
+  {
+    return is_implemented(GX_ENUM_TRIGGER_MODE);
+  }
+
+  void set_trigger_mode(const GX_TRIGGER_MODE_ENTRY value)
+  {
+    feature<GX_ENUM_TRIGGER_MODE>().set(value);
+  }
+
+  GX_TRIGGER_MODE_ENTRY trigger_mode() const
+  {
+    return Feature<GX_ENUM_TRIGGER_MODE>::read(*this);
+  }
+
+  bool is_trigger_source_implemented() const
+  {
+    return is_implemented(GX_ENUM_TRIGGER_SOURCE);
+  }
+
+  void set_trigger_source(const GX_TRIGGER_SOURCE_ENTRY value)
+  {
+    feature<GX_ENUM_TRIGGER_SOURCE>().set(value);
+  }
+
+  GX_TRIGGER_SOURCE_ENTRY trigger_source() const
+  {
+    return Feature<GX_ENUM_TRIGGER_SOURCE>::read(*this);
+  }
+
+  bool is_external_trigger_switch_implemented() const
+  {
+    return is_implemented(GX_ENUM_TRIGGER_SWITCH);
+  }
+
+  void set_external_trigger_switch(const GX_TRIGGER_SWITCH_ENTRY value)
+  {
+    feature<GX_ENUM_TRIGGER_SWITCH>().set(value);
+  }
+
+  GX_TRIGGER_SWITCH_ENTRY external_trigger_switch() const
+  {
+    return Feature<GX_ENUM_TRIGGER_SWITCH>::read(*this);
+  }
+
+  bool is_trigger_filter_raising_implemented() const
+  {
+    return is_implemented(GX_FLOAT_TRIGGER_FILTER_RAISING);
+  }
+
+  void set_trigger_filter_raising(const double value)
+  {
+    feature<GX_FLOAT_TRIGGER_FILTER_RAISING>().set(value);
+  }
+
+  double trigger_filter_raising() const
+  {
+    return Feature<GX_FLOAT_TRIGGER_FILTER_RAISING>::read(*this);
+  }
+
+  std::pair<double, double> trigger_filter_raising_range() const
+  {
+    return Feature<GX_FLOAT_TRIGGER_FILTER_RAISING>::read_range(*this);
+  }
+
+  bool is_trigger_filter_falling_implemented() const
+  {
+    return is_implemented(GX_FLOAT_TRIGGER_FILTER_FALLING);
+  }
+
+  void set_trigger_filter_falling(const double value)
+  {
+    feature<GX_FLOAT_TRIGGER_FILTER_FALLING>().set(value);
+  }
+
+  double trigger_filter_falling() const
+  {
+    return Feature<GX_FLOAT_TRIGGER_FILTER_FALLING>::read(*this);
+  }
+
+  std::pair<double, double> trigger_filter_falling_range() const
+  {
+    return Feature<GX_FLOAT_TRIGGER_FILTER_FALLING>::read_range(*this);
+  }
+
+  bool is_trigger_delay_implemented() const
+  {
+    return is_implemented(GX_FLOAT_TRIGGER_DELAY);
+  }
+
+  void set_trigger_delay(const double value)
+  {
+    feature<GX_FLOAT_TRIGGER_DELAY>().set(value);
+  }
+
+  double trigger_delay() const
+  {
+    return Feature<GX_FLOAT_TRIGGER_DELAY>::read(*this);
+  }
+
+  std::pair<double, double> trigger_delay_range() const
+  {
+    return Feature<GX_FLOAT_TRIGGER_DELAY>::read_range(*this);
+  }
+
+  bool is_exposure_time_implemented() const
+  {
+    return is_implemented(GX_FLOAT_EXPOSURE_TIME);
+  }
+
+  void set_exposure_time(const double value)
+  {
+    feature<GX_FLOAT_EXPOSURE_TIME>().set(value);
+  }
+
+  double exposure_time() const
+  {
+    return Feature<GX_FLOAT_EXPOSURE_TIME>::read(*this);
+  }
+
+  std::pair<double, double> exposure_time_range() const
+  {
+    return Feature<GX_FLOAT_EXPOSURE_TIME>::read_range(*this);
+  }
+
+  bool is_exposure_delay_implemented() const
+  {
+    return is_implemented(GX_FLOAT_EXPOSURE_DELAY);
+  }
+
+  void set_exposure_delay(const double value)
+  {
+    feature<GX_FLOAT_EXPOSURE_DELAY>().set(value);
+  }
+
+  double exposure_delay() const
+  {
+    return Feature<GX_FLOAT_EXPOSURE_DELAY>::read(*this);
+  }
+
+  std::pair<double, double> exposure_delay_range() const
+  {
+    return Feature<GX_FLOAT_EXPOSURE_DELAY>::read_range(*this);
+  }
+
+  bool is_exposure_mode_implemented() const
+  {
+    return is_implemented(GX_ENUM_EXPOSURE_MODE);
+  }
+
+  void set_exposure_mode(const GX_EXPOSURE_MODE_ENTRY value)
+  {
+    feature<GX_ENUM_EXPOSURE_MODE>().set(value);
+  }
+
+  GX_EXPOSURE_MODE_ENTRY exposure_mode() const
+  {
+    return Feature<GX_ENUM_EXPOSURE_MODE>::read(*this);
+  }
+
+  bool is_exposure_auto_implemented() const
+  {
+    return is_implemented(GX_ENUM_EXPOSURE_AUTO);
+  }
+
+  void set_exposure_auto(const GX_EXPOSURE_AUTO_ENTRY value)
+  {
+    feature<GX_ENUM_EXPOSURE_AUTO>().set(value);
+  }
+
+  GX_EXPOSURE_AUTO_ENTRY exposure_auto() const
+  {
+    return Feature<GX_ENUM_EXPOSURE_AUTO>::read(*this);
+  }
+
+  /// @}
+
+  /// @name Analog controls
+  /// @{
+
+  bool is_gain_auto_implemented() const
+  {
+    return is_implemented(GX_ENUM_GAIN_AUTO);
+  }
+
+  void set_gain_auto(const GX_GAIN_AUTO_ENTRY value)
+  {
+    feature<GX_ENUM_GAIN_AUTO>().set(value);
+  }
+
+  GX_GAIN_AUTO_ENTRY gain_auto() const
+  {
+    return Feature<GX_ENUM_GAIN_AUTO>::read(*this);
+  }
+
+  bool is_gain_implemented() const
+  {
+    return is_implemented(GX_FLOAT_GAIN);
+  }
+
+  void set_gain(const GX_GAIN_SELECTOR_ENTRY channel, const double value)
+  {
+    set_enum(GX_ENUM_GAIN_SELECTOR, channel);
+    set_float(GX_FLOAT_GAIN, value);
+  }
+
+  double gain(const GX_GAIN_SELECTOR_ENTRY channel) const
+  {
+    set_enum(GX_ENUM_GAIN_SELECTOR, channel);
+    return get_float(GX_FLOAT_GAIN);
+  }
+
+  std::pair<double, double> gain_range(const GX_GAIN_SELECTOR_ENTRY channel) const
+  {
+    set_enum(GX_ENUM_GAIN_SELECTOR, channel);
+    return get_float_range(GX_FLOAT_GAIN);
+  }
+
+  bool is_balance_ratio_implemented() const
+  {
+    return is_implemented(GX_FLOAT_BALANCE_RATIO);
+  }
+
+  void set_balance_ratio(const GX_BALANCE_RATIO_SELECTOR_ENTRY channel, const double value)
+  {
+    set_enum(GX_ENUM_BALANCE_RATIO_SELECTOR, channel);
+    set_float(GX_FLOAT_BALANCE_RATIO, value);
+  }
+
+  double balance_ratio(const GX_BALANCE_RATIO_SELECTOR_ENTRY channel) const
+  {
+    set_enum(GX_ENUM_BALANCE_RATIO_SELECTOR, channel);
+    return get_float(GX_FLOAT_BALANCE_RATIO);
+  }
+
+  std::pair<double, double> balance_ratio_range(const GX_BALANCE_RATIO_SELECTOR_ENTRY channel) const
+  {
+    set_enum(GX_ENUM_BALANCE_RATIO_SELECTOR, channel);
+    return get_float_range(GX_FLOAT_BALANCE_RATIO);
+  }
+
+  /// @}
+
+  /// @name Chunk data
+  /// @{
+
+  bool is_chunk_mode_implemented() const
+  {
+    return is_implemented(GX_BOOL_CHUNKMODE_ACTIVE);
+  }
+
+  /**
+   * Enables or disables the appending of chunk data to the payload.
+   *
+   * @see Chunk_view.
+   */
+  void set_chunk_mode_active(const bool value)
+  {
+    feature<GX_BOOL_CHUNKMODE_ACTIVE>().set(value);
+  }
+
+  bool is_chunk_mode_active() const
+  {
+    return Feature<GX_BOOL_CHUNKMODE_ACTIVE>::read(*this);
+  }
+
+  bool is_chunk_selector_implemented() const
+  {
+    return is_implemented(GX_ENUM_CHUNK_SELECTOR);
+  }
+
+  /// Enables or disables the inclusion of the `chunk` in the payload.
+  void set_chunk_enabled(const GX_CHUNK_SELECTOR_ENTRY chunk, const bool value)
+  {
+    set_enum(GX_ENUM_CHUNK_SELECTOR, chunk);
+    set_bool(GX_BOOL_CHUNK_ENABLE, value);
+  }
+
+  /// @returns `true` if the `chunk` is included in the payload.
+  bool is_chunk_enabled(const GX_CHUNK_SELECTOR_ENTRY chunk)
+  {
+    set_enum(GX_ENUM_CHUNK_SELECTOR, chunk);
+    return get_bool(GX_BOOL_CHUNK_ENABLE);
+  }
+
+  /// @}
+
+  /// @name Flow layer (DataStream feature)
+
+  bool is_stream_transfer_size_implemented() const
+  {
+    return is_implemented(GX_DS_INT_STREAM_TRANSFER_SIZE);
+  }
+
+  void set_stream_transfer_size(const std::int64_t value)
+  {
+    feature<GX_DS_INT_STREAM_TRANSFER_SIZE>().set(value);
+  }
+
+  std::int64_t stream_transfer_size()
+  {
+    return feature<GX_DS_INT_STREAM_TRANSFER_SIZE>().get();
+  }
+
+  /// @}
+
+  /// @name Memory
+  /// @{
+
+  /**
+   * Sets the NUMA node of the device. This node should be the node closest
+   * to the USB or PCIe controller to which the device is connected.
+   *
+   * If `value >= 0` then:
+   *   -# the buffers allocated by capture() are placed on the node (unless
+   *   the memory resource is set);
+   *   -# the thread which calls the capture callback (registered after this
+   *   call) is pinned to the CPUs of the node.
+   *
+   * @param value The NUMA node, or `-1` to reset.
+   *
+   * @see numa_node_of_network_interface(), numa_node_of_pci_device(),
+   * numa_node_of_usb_bus(), Thread_pool.
+   */
+  void set_numa_node(const int value) noexcept
+  {
+    numa_node_ = value < 0 ? -1 : value;
+  }
+
+  /// @returns The NUMA node of the device, or `-1` if not set.
+  int numa_node() const noexcept
+  {
+    return numa_node_;
+  }
+
+  /**
+   * Sets the memory resource to allocate the buffers of capture() from (for
+   * example, Huge_page_arena, `std::pmr::synchronized_pool_resource` or a
+   * resource of shared memory).
+   *
+   * @param value The memory resource, or `nullptr` to reset. (If set, it takes
+   * precedence over the NUMA node of the device.)
+   *
+   * @warning The memory resource must outlive all the frames captured.
+   */
+  void set_memory_resource(std::pmr::memory_resource* const value) noexcept
+  {
+    memory_resource_ = value;
+  }
+
+  /**
+   * @returns The memory resource to allocate the buffers of capture() from,
+   * or `nullptr` if not set.
+   */
+  std::pmr::memory_resource* memory_resource() const noexcept
+  {
+    return memory_resource_;
+  }
+
+  /// @}
+
+  /// @name Generic feature access
+  /// @{
+
+  /**
+   * Reads the features of the given `results[i].id` in one pass, storing the
+   * value and the status of each feature into `results[i]`. Failures don't
+   * stop the batch and cost no error lookup, so the reading of many features
+   * (for example, for monitoring) has a stable latency.
+   *
+   * @returns The number of features which are read successfully.
+   *
+   * @remarks Reading of command and buffer features fails with the status
+   * `GX_STATUS_ERROR_TYPE`.
+   */
+  std::size_t read_features(Feature_read* const results, const std::size_t count) const noexcept
+  {
+    std::size_t result{};
+    for (std::size_t i{}; i < count; ++i) {
+      auto& r = results[i];
+      r.status = read_feature_nothrow(handle_, r.id, r.value);
+      result += r.status == GX_STATUS_SUCCESS;
+    }
+    return result;
+  }
+
+  /// @overload
+  std::size_t read_features(std::vector<Feature_read>& results) const noexcept
+  {
+    return read_features(results.data(), results.size());
+  }
+
+  /// @returns The typed accessor of the feature of the given ID.
+  template<GX_FEATURE_ID Id>
+  Feature<Id> feature() noexcept
+  {
+    return Feature<Id>{*this};
+  }
+
+  /**
+   * @returns The value of the `feature`.
+   *
+   * @par Requires
+   * The `feature` is not a command, nor a buffer feature.
+   */
+  Feature_value get(const GX_FEATURE_ID feature) const
+  {
+    switch (feature_type(feature)) {
+    case GX_FEATURE_INT: return get_int(feature);
+    case GX_FEATURE_ENUM: return get_enum(feature);
+    case GX_FEATURE_FLOAT: return get_float(feature);
+    case GX_FEATURE_BOOL: return get_bool(feature);
+    case GX_FEATURE_STRING: return get_string(feature);
+    default:
+      throw std::invalid_argument{"feature has no value"};
+    }
+  }
+
+  /**
+   * @overload
+   *
+   * @param name The GenICam name of the feature (see feature_infos).
+   */
+  Feature_value get(const std::string_view name) const
+  {
+    return get(feature_id(name));
+  }
+
+  /**
+   * Sets the `value` of the `feature`. Integer values are accepted by float
+   * features.
+   *
+   * @par Requires
+   * The `feature` is not a command, nor a buffer feature, and the type of
+   * the `value` matches the type of the `feature`.
+   */
+  void set(const GX_FEATURE_ID feature, const Feature_value& value)
+  {
+    const auto type = feature_type(feature);
+    if ((type == GX_FEATURE_INT || type == GX_FEATURE_ENUM) &&
+      std::holds_alternative<std::int64_t>(value)) {
+      if (type == GX_FEATURE_INT)
+        set_int(feature, std::get<std::int64_t>(value));
+      else
+        set_enum(feature, std::get<std::int64_t>(value));
+    } else if (type == GX_FEATURE_FLOAT && std::holds_alternative<double>(value))
+      set_float(feature, std::get<double>(value));
+    else if (type == GX_FEATURE_FLOAT && std::holds_alternative<std::int64_t>(value))
+      set_float(feature, static_cast<double>(std::get<std::int64_t>(value)));
+    else if (type == GX_FEATURE_BOOL && std::holds_alternative<bool>(value))
+      set_bool(feature, std::get<bool>(value));
+    else if (type == GX_FEATURE_STRING && std::holds_alternative<std::string>(value))
+      set_string(feature, std::get<std::string>(value));
+    else
+      throw std::invalid_argument{"invalid type of feature value"};
+  }
+
+  /**
+   * @overload
+   *
+   * @param name The GenICam name of the feature (see feature_infos).
+   */
+  void set(const std::string_view name, const Feature_value& value)
+  {
+    set(feature_id(name), value);
+  }
+
+  /**
+   * Executes the command `feature`.
+   *
+   * @par Requires
+   * The `feature` is a command.
+   */
+  void execute(const GX_FEATURE_ID feature)
+  {
+    if (feature_type(feature) != GX_FEATURE_COMMAND)
+      throw std::invalid_argument{"feature is not a command"};
+    call(GXSendCommand, handle_, feature);
+  }
+
+  /// @overload
+  void execute(const std::string_view name)
+  {
+    execute(feature_id(name));
+  }
+
+  /// @}
+
+  /// @name Control
+  /// @{
+
+  void register_capture_callback(GXCaptureCallBack callback, void* const data = {})
+  {
+    if (numa_node_ < 0) {
+      call(GXRegisterCaptureCallback, handle_, data, callback);
+      return;
+    }
+
+    auto cb = std::make_unique<Capture_callback>();
+    cb->function = callback;
+    cb->data = data;
+    cb->numa_node = numa_node_;
+    call(GXRegisterCaptureCallback, handle_, static_cast<void*>(cb.get()),
+      &Capture_callback::trampoline);
+    capture_callback_ = std::move(cb);
+  }
+
+  void unregister_capture_callback()
+  {
+    call(GXUnregisterCaptureCallback, handle_);
+  }
+
+  /**
+   * @returns The first error of pinning the threads which call the capture
+   * callback to the NUMA node of the device, or `nullptr`. (The callback is
+   * called anyway, on the unpinned thread.)
+   *
+   * @remarks Thread-safe with respect to calls of the callback.
+   */
+  std::exception_ptr capture_callback_pin_error() const
+  {
+    if (!capture_callback_)
+      return nullptr;
+    const std::lock_guard lg{capture_callback_->mutex};
+    return capture_callback_->pin_error;
+  }
+
+  void set_capture_callback(GXCaptureCallBack callback, void* const data = {})
+  {
+    GXUnregisterCaptureCallback(handle_);
+    register_capture_callback(callback, data);
+  }
+
+  void start_acquisition()
+  {
+    call(GXStreamOn, handle_);
+  }
+
+  void stop_acquisition()
+  {
+    call(GXStreamOff, handle_);
+  }
+
+  Frame_data capture(const std::chrono::milliseconds timeout)
+  {
+    Frame_data result;
+    capture(result, timeout);
+    return result;
+  }
+
+  /**
+   * @overload
+   *
+   * @details Captures into the buffer of the given `frame` if its capacity
+   * is enough for the payload, or reallocates it otherwise. This allows to
+   * capture without allocations (for example, into the frames of Frame_pool).
+   */
+  void capture(Frame_data& frame, const std::chrono::milliseconds timeout)
+  {
+    const auto size = static_cast<std::size_t>(payload_size());
+    if (!frame.data.pImgBuf || frame.capacity < size)
+      frame = Frame_data{size,
+        memory_resource_ ? memory_resource_ : numa_memory_resource(numa_node_)};
+    call(GXGetImage, handle_, &frame.data, static_cast<std::int32_t>(timeout.count()));
+  }
+
+  void trigger_capture()
+  {
+    feature<GX_COMMAND_TRIGGER_SOFTWARE>().execute();
+  }
+
+  void flush_queue()
+  {
+    call(GXFlushQueue, handle_);
+  }
+
+  /// @}
+
+  /// @name Events
+  /// @{
+
+  /**
+   * Enables the notification of the `event` by the device and registers the
+   * `callback` of it (replacing the previous one, if any).
+   *
+   * @param data The user data to pass to the `callback`.
+   * @param time_base If specified, the latency from events to calls of the
+   * `callback` is measured.
+   *
+   * @remarks The `callback` is called by the thread of SDK, so it must not
+   * block.
+   * @remarks On failure, the previous callback (if any) remains registered.
+   *
+   * @see event_latency(), time_base().
+   */
+  void register_event_callback(const Event event, const Event_callback callback,
+    void* const data = {}, const std::optional<Time_base>& time_base = {})
+  {
+    if (!callback)
+      throw std::invalid_argument{"invalid event callback"};
+
+    const auto features = event_features(event);
+    auto handler = std::make_unique<Event_handler>();
+    handler->device = handle_;
+    handler->event = event;
+    handler->features = features;
+    handler->function = callback;
+    handler->data = data;
+    handler->time_base = time_base;
+
+    /*
+     * Register the new callback first and enable the notification then, so
+     * no event is notified without the callback. On failure, the new callback
+     * is unregistered, the notification is disabled unless it's used by the
+     * previous callback, and the previous callback is kept.
+     */
+    auto& current = event_handlers_[static_cast<std::size_t>(event)];
+    call(GXRegisterFeatureCallback, handle_, static_cast<void*>(handler.get()),
+      &Event_handler::trampoline, features.id, &handler->handle);
+    try {
+      set_enum(GX_ENUM_EVENT_SELECTOR, features.selector);
+      set_enum(GX_ENUM_EVENT_NOTIFICATION, GX_ENUM_EVENT_NOTIFICATION_ON);
+      if (current)
+        call(GXUnregisterFeatureCallback, handle_, features.id, current->handle);
+    } catch (...) {
+      GXUnregisterFeatureCallback(handle_, features.id, handler->handle);
+      if (!current) {
+        if (GXSetEnum(handle_, GX_ENUM_EVENT_SELECTOR, features.selector) == GX_STATUS_SUCCESS)
+          GXSetEnum(handle_, GX_ENUM_EVENT_NOTIFICATION, GX_ENUM_EVENT_NOTIFICATION_OFF);
+      }
+      throw;
+    }
+    current = std::move(handler);
+  }
+
+  /**
+   * Unregisters the callback of the `event` (if any) and disables the
+   * notification of it.
+   */
+  void unregister_event_callback(const Event event)
+  {
+    auto& handler = event_handlers_[static_cast<std::size_t>(event)];
+    if (!handler)
+      return;
+
+    const auto features = handler->features;
+    call(GXUnregisterFeatureCallback, handle_, features.id, handler->handle);
+    handler.reset();
+    set_enum(GX_ENUM_EVENT_SELECTOR, features.selector);
+    set_enum(GX_ENUM_EVENT_NOTIFICATION, GX_ENUM_EVENT_NOTIFICATION_OFF);
+  }
+
+  /**
+   * @returns The statistics of the latency of the callback of the `event`
+   * (which is empty if the callback isn't registered with the time base).
+   *
+   * @remarks Thread-safe with respect to calls of the callback.
+   */
+  Event_latency event_latency(const Event event) const noexcept
+  {
+    const auto& handler = event_handlers_[static_cast<std::size_t>(event)];
+    Event_latency result;
+    if (handler) {
+      result.count = handler->latency_count.load(std::memory_order_relaxed);
+      result.min = handler->latency_min.load(std::memory_order_relaxed);
+      result.max = handler->latency_max.load(std::memory_order_relaxed);
+      result.sum = handler->latency_sum.load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  /**
+   * Registers the `callback` which is called when the `feature` is changed
+   * (replacing the previous one, if any).
+   *
+   * @param data The user data to pass to the `callback`.
+   *
+   * @remarks The `callback` is called by the thread of SDK, so it must not
+   * block.
+   */
+  void register_feature_callback(const GX_FEATURE_ID feature,
+    const Feature_callback callback, void* const data = {})
+  {
+    if (!callback)
+      throw std::invalid_argument{"invalid feature callback"};
+
+    unregister_feature_callback(feature);
+    auto handler = std::make_unique<Feature_handler>();
+    handler->device = handle_;
+    handler->function = callback;
+    handler->data = data;
+    call(GXRegisterFeatureCallback, handle_, static_cast<void*>(handler.get()),
+      &Feature_handler::trampoline, feature, &handler->handle);
+    feature_handlers_[feature] = std::move(handler);
+  }
+
+  /// Unregisters the callback of the `feature` (if any).
+  void unregister_feature_callback(const GX_FEATURE_ID feature)
+  {
+    if (const auto i = feature_handlers_.find(feature); i != feature_handlers_.end()) {
+      call(GXUnregisterFeatureCallback, handle_, feature, i->second->handle);
+      feature_handlers_.erase(i);
+    }
+  }
+
+  /// @returns The number of events in the event queue of the device.
+  std::uint32_t event_queue_size() const
+  {
+    std::uint32_t result{};
+    call(GXGetEventNumInQueue, handle_, &result);
+    return result;
+  }
+
+  /// Discards the events of the event queue of the device.
+  void flush_events()
+  {
+    call(GXFlushEvent, handle_);
+  }
+
+  /// @}
+
+private:
+  template<GX_FEATURE_ID, class> friend class Feature;
+
+  /**
+   * Pins the calling thread to the NUMA node before calling the callback.
+   * Pinning is attempted once per thread, the first error is kept.
+   */
+  struct Capture_callback final {
+    GXCaptureCallBack function{};
+    void* data{};
+    int numa_node{-1};
+    std::mutex mutex;
+    std::exception_ptr pin_error;
+
+    static void GX_STDC trampoline(GX_FRAME_CALLBACK_PARAM* const param)
+    {
+      auto* const self = static_cast<Capture_callback*>(param->pUserParam);
+      thread_local int attempted_node{-1};
+      if (attempted_node != self->numa_node) {
+        attempted_node = self->numa_node;
+        try {
+          pin_current_thread_to_numa_node(self->numa_node);
+        } catch (...) {
+          const std::lock_guard lg{self->mutex};
+          if (!self->pin_error)
+            self->pin_error = std::current_exception();
+        }
+      }
+      param->pUserParam = self->data;
+      self->function(param);
+    }
+  };
+
+  /// Reads the data of the event and measures the latency of the callback.
+  struct Event_handler final {
+    GX_DEV_HANDLE device{};
+    Event event{};
+    Event_features features;
+    Event_callback function{};
+    void* data{};
+    std::optional<Time_base> time_base;
+    GX_FEATURE_CALLBACK_HANDLE handle{};
+    std::atomic<std::uint64_t> latency_count{};
+    std::atomic<std::int64_t> latency_min{INT64_MAX};
+    std::atomic<std::int64_t> latency_max{INT64_MIN};
+    std::atomic<std::int64_t> latency_sum{};
+
+    static void GX_STDC trampoline(GX_FEATURE_ID, void* const param)
+    {
+      const auto now = std::chrono::steady_clock::now();
+      auto* const self = static_cast<Event_handler*>(param);
+      Event_data event;
+      event.event = self->event;
+      std::int64_t value{};
+      if (GXGetInt(self->device, self->features.timestamp, &value) == GX_STATUS_SUCCESS)
+        event.timestamp = static_cast<std::uint64_t>(value);
+      if (self->features.frame_id &&
+        GXGetInt(self->device, self->features.frame_id, &value) == GX_STATUS_SUCCESS)
+        event.frame_id = static_cast<std::uint64_t>(value);
+      if (self->time_base && event.timestamp) {
+        event.latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          now.time_since_epoch()).count() - self->time_base->to_nanoseconds(event.timestamp);
+        self->record_latency(event.latency);
+      }
+      self->function(event, self->data);
+    }
+
+    void record_latency(const std::int64_t latency) noexcept
+    {
+      // The only writer is the thread of SDK, so there are no races here.
+      if (latency < latency_min.load(std::memory_order_relaxed))
+        latency_min.store(latency, std::memory_order_relaxed);
+      if (latency > latency_max.load(std::memory_order_relaxed))
+        latency_max.store(latency, std::memory_order_relaxed);
+      latency_sum.fetch_add(latency, std::memory_order_relaxed);
+      latency_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  };
+
+  /// Reads the new value of the feature before calling the callback.
+  struct Feature_handler final {
+    GX_DEV_HANDLE device{};
+    Feature_callback function{};
+    void* data{};
+    GX_FEATURE_CALLBACK_HANDLE handle{};
+    Feature_read change;
+
+    static void GX_STDC trampoline(const GX_FEATURE_ID feature, void* const param)
+    {
+      auto* const self = static_cast<Feature_handler*>(param);
+      self->change.id = feature;
+      self->change.status = read_feature_nothrow(self->device, feature,
+        self->change.value);
+      self->function(self->change, self->data);
+    }
+  };
+
+  GX_DEV_HANDLE handle_{};
+  int numa_node_{-1};
+  std::pmr::memory_resource* memory_resource_{};
+  std::unique_ptr<Capture_callback> capture_callback_;
+  std::array<std::unique_ptr<Event_handler>, event_count> event_handlers_;
+  std::map<GX_FEATURE_ID, std::unique_ptr<Feature_handler>> feature_handlers_;
+
+  void unregister_feature_callbacks_nothrow() noexcept
+  {
+    for (auto& handler : event_handlers_) {
+      if (handler) {
+        GXUnregisterFeatureCallback(handle_, handler->features.id, handler->handle);
+        handler.reset();
+      }
+    }
+    for (const auto& [feature, handler] : feature_handlers_)
+      GXUnregisterFeatureCallback(handle_, feature, handler->handle);
+    feature_handlers_.clear();
+  }
+
+  std::int64_t get_enum(const GX_FEATURE_ID feature) const
+  {
+    std::int64_t result{};
+    call(GXGetEnum, handle_, feature, &result);
+    return result;
+  }
+
+  void set_enum(const GX_FEATURE_ID feature, const std::int64_t value) const
+  {
+    call(GXSetEnum, handle_, feature, value);
+  }
+
+  double get_float(const GX_FEATURE_ID feature) const
+  {
+    double result{};
+    call(GXGetFloat, handle_, feature, &result);
+    return result;
+  }
+
+  void set_float(const GX_FEATURE_ID feature, const double value)
+  {
+    call(GXSetFloat, handle_, feature, value);
+  }
+
+  std::int64_t get_int(const GX_FEATURE_ID feature) const
+  {
+    std::int64_t result{};
+    call(GXGetInt, handle_, feature, &result);
+    return result;
+  }
+
+  void set_int(const GX_FEATURE_ID feature, const std::int64_t value)
+  {
+    call(GXSetInt, handle_, feature, value);
+  }
+
+  std::string get_string(const GX_FEATURE_ID feature) const
+  {
+    std::size_t size{};
+    call(GXGetStringLength, handle_, feature, &size);
+    std::string result(size, '\0');
+    call(GXGetString, handle_, feature, result.data(), &size);
+    result.resize(std::strlen(result.c_str()));
+    return result;
+  }
+
+  void set_string(const GX_FEATURE_ID feature, std::string value)
+  {
+    call(GXSetString, handle_, feature, value.data());
+  }
+
+  static GX_STATUS read_feature_nothrow(const GX_DEV_HANDLE device,
+    const GX_FEATURE_ID feature, Feature_value& value) noexcept
+  {
+    GX_STATUS status{GX_STATUS_ERROR_TYPE};
+    switch (feature_type(feature)) {
+    case GX_FEATURE_INT:
+    case GX_FEATURE_ENUM: {
+      std::int64_t v{};
+      status = feature_type(feature) == GX_FEATURE_INT ?
+        GXGetInt(device, feature, &v) : GXGetEnum(device, feature, &v);
+      value = v;
+      break;
+    }
+    case GX_FEATURE_FLOAT: {
+      double v{};
+      status = GXGetFloat(device, feature, &v);
+      value = v;
+      break;
+    }
+    case GX_FEATURE_BOOL: {
+      bool v{};
+      status = GXGetBool(device, feature, &v);
+      value = v;
+      break;
+    }
+    case GX_FEATURE_STRING:
+      try {
+        std::size_t size{};
+        if ((status = GXGetStringLength(device, feature, &size)) != GX_STATUS_SUCCESS)
+          break;
+        // Reuse the string (and its capacity) of the previous read.
+        if (!std::holds_alternative<std::string>(value))
+          value = std::string{};
+        auto& v = std::get<std::string>(value);
+        v.resize(size);
+        status = GXGetString(device, feature, v.data(), &size);
+        v.resize(std::strlen(v.c_str()));
+      } catch (...) {
+        status = GX_STATUS_ERROR;
+      }
+      break;
+    default:
+      break;
+    }
+    return status;
+  }
+
+  /// @returns The ID of the feature of the given `name`.
+  static GX_FEATURE_ID feature_id(const std::string_view name)
+  {
+    if (const auto* const info = find_feature(name))
+      return info->id;
+    throw std::invalid_argument{std::string{"unknown feature "}.append(name)};
+  }
+
+  bool get_bool(const GX_FEATURE_ID feature) const
+  {
+    bool result{};
+    call(GXGetBool, handle_, feature, &result);
+    return result;
+  }
+
+  void set_bool(const GX_FEATURE_ID feature, const bool value)
+  {
+    call(GXSetBool, handle_, feature, value);
+  }
+
+  std::pair<std::int64_t, std::int64_t> get_int_range(const GX_FEATURE_ID feature) const
+  {
+    GX_INT_RANGE result{};
+    call(GXGetIntRange, handle_, feature, &result);
+    return {result.nMin, result.nMax};
+  }
+
+  std::pair<double, double> get_float_range(const GX_FEATURE_ID feature) const
+  {
+    GX_FLOAT_RANGE result{};
+    call(GXGetFloatRange, handle_, feature, &result);
+    return {result.dMin, result.dMax};
+  }
+
+  bool is_implemented(const GX_FEATURE_ID feature) const
+  {
+    bool result{};
+    call(GXIsImplemented, handle_, feature, &result);
+    return result;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Class Feature implementation
+// -----------------------------------------------------------------------------
+
+template<GX_FEATURE_ID Id, class Cache>
+bool Feature<Id, Cache>::is_implemented() const
+{
+  return device_->is_implemented(Id);
+}
+
+template<GX_FEATURE_ID Id, class Cache>
+auto Feature<Id, Cache>::get() const -> Value
+{
+  static_assert(!std::is_void_v<Value>, "command features have no value");
+  if constexpr (std::is_same_v<Cache, No_feature_cache>)
+    return read(*device_);
+  else {
+    if (const auto& cached = cache_.load())
+      return *cached;
+
+    auto result = read(*device_);
+    cache_.store(result);
+    return result;
+  }
+}
+
+template<GX_FEATURE_ID Id, class Cache>
+void Feature<Id, Cache>::set(
+  const std::conditional_t<std::is_void_v<Value>, std::monostate, Value>& value)
+{
+  static_assert(!std::is_void_v<Value>, "command features have no value");
+  if constexpr (type == GX_FEATURE_INT)
+    device_->set_int(Id, value);
+  else if constexpr (type == GX_FEATURE_ENUM)
+    device_->set_enum(Id, static_cast<std::int64_t>(value));
+  else if constexpr (type == GX_FEATURE_FLOAT)
+    device_->set_float(Id, value);
+  else if constexpr (type == GX_FEATURE_BOOL)
+    device_->set_bool(Id, value);
+  else
+    device_->set_string(Id, value);
+  if constexpr (!std::is_same_v<Cache, No_feature_cache>)
+    cache_.store(value);
+}
+
+template<GX_FEATURE_ID Id, class Cache>
+template<typename, typename>
+void Feature<Id, Cache>::execute()
+{
+  call(GXSendCommand, device_->handle(), Id);
+}
+
+template<GX_FEATURE_ID Id, class Cache>
+auto Feature<Id, Cache>::read(const Device& device) -> Value
+{
+  static_assert(!std::is_void_v<Value>, "command features have no value");
+  if constexpr (type == GX_FEATURE_INT)
+    return device.get_int(Id);
+  else if constexpr (type == GX_FEATURE_ENUM)
+    return static_cast<Value>(device.get_enum(Id));
+  else if constexpr (type == GX_FEATURE_FLOAT)
+    return device.get_float(Id);
+  else if constexpr (type == GX_FEATURE_BOOL)
+    return device.get_bool(Id);
+  else
+    return device.get_string(Id);
+}
+
+template<GX_FEATURE_ID Id, class Cache>
+template<typename V, typename>
+std::pair<V, V> Feature<Id, Cache>::read_range(const Device& device)
+{
+  if constexpr (type == GX_FEATURE_INT)
+    return device.get_int_range(Id);
+  else
+    return device.get_float_range(Id);
+}
+
+// -----------------------------------------------------------------------------
+// Chunk data
+// -----------------------------------------------------------------------------
+
+/// The byte order of chunk data.
+enum class Byte_order {
+  /// Little-endian (USB3 Vision devices).
+  little,
+  /// Big-endian (GigE Vision devices).
+  big
+};
+
+/// The chunk of the payload. The data is not copied.
+struct Chunk final {
+  /// The chunk ID (as specified by the device description).
+  std::uint32_t id{};
+  /// The data of the chunk within the payload.
+  const std::uint8_t* data{};
+  /// The size of the data.
+  std::uint32_t size{};
+};
+
+/**
+ * @returns The value of the `chunk` of the given `byte_order`, or
+ * `std::nullopt` if the size of the chunk is less than `sizeof(T)`.
+ *
+ * @tparam T An arithmetic type.
+ */
+template<typename T>
+inline std::optional<T> chunk_value(const Chunk& chunk, const Byte_order byte_order) noexcept
+{
+  static_assert(std::is_arithmetic_v<T>);
+  if (chunk.size < sizeof(T))
+    return std::nullopt;
+
+  std::uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, chunk.data, sizeof(T));
+  const std::uint16_t probe{1};
+  const bool is_host_little{*reinterpret_cast<const std::uint8_t*>(&probe) == 1};
+  if ((byte_order == Byte_order::little) != is_host_little)
+    std::reverse(bytes, bytes + sizeof(T));
+  T result;
+  std::memcpy(&result, bytes, sizeof(T));
+  return result;
+}
+
+/**
+ * A zero-copy view of the chunks appended to the payload of the frame (see
+ * Device::set_chunk_mode_active()).
+ *
+ * @details Each chunk is followed by the trailer of its ID and size (32-bit
+ * each), so the chunks are walked backward from the end of the payload. The
+ * metadata chunks (frame ID, timestamp, exposure time, gain etc.) are usually
+ * the last ones, so the lookup of them doesn't touch the image data.
+ */
+class Chunk_view final {
+public:
+  /// The size of the trailer of each chunk.
+  static constexpr std::size_t trailer_size{8};
+
+  /// Constructs an empty view.
+  Chunk_view() = default;
+
+  /// The constructor.
+  Chunk_view(const void* const payload, const std::size_t size,
+    const Byte_order byte_order = Byte_order::little) noexcept
+    : payload_{static_cast<const std::uint8_t*>(payload)}
+    , size_{payload ? size : 0}
+    , byte_order_{byte_order}
+  {}
+
+  /// @overload
+  explicit Chunk_view(const GX_FRAME_DATA& frame,
+    const Byte_order byte_order = Byte_order::little) noexcept
+    : Chunk_view{frame.pImgBuf, frame.nImgSize > 0 ?
+      static_cast<std::size_t>(frame.nImgSize) : 0, byte_order}
+  {}
+
+  /// @returns The byte order.
+  Byte_order byte_order() const noexcept
+  {
+    return byte_order_;
+  }
+
+  /**
+   * Calls `callback(chunk)` for each chunk, starting from the last one,
+   * until it returns `false`.
+   *
+   * @returns `false` if the walk is stopped by the malformed trailer, or
+   * `true` otherwise.
+   */
+  template<typename F>
+  bool for_each(F&& callback) const
+  {
+    std::size_t end{size_};
+    while (end >= trailer_size) {
+      const auto id = *chunk_value<std::uint32_t>(
+        Chunk{0, payload_ + end - trailer_size, 4}, byte_order_);
+      const auto size = *chunk_value<std::uint32_t>(
+        Chunk{0, payload_ + end - trailer_size / 2, 4}, byte_order_);
+      if (size > end - trailer_size)
+        return false;
+
+      end -= trailer_size + size;
+      if (!callback(Chunk{id, payload_ + end, size}))
+        return true;
+    }
+    return !end;
+  }
+
+  /// @returns The chunk of the given `id`.
+  std::optional<Chunk> find(const std::uint32_t id) const noexcept
+  {
+    std::optional<Chunk> result;
+    for_each([&](const Chunk& chunk)
+    {
+      if (chunk.id == id)
+        result = chunk;
+      return !result;
+    });
+    return result;
+  }
+
+  /**
+   * @returns The value of the chunk of the given `id`, or `std::nullopt` if
+   * there is no such a chunk or its size is less than `sizeof(T)`.
+   *
+   * @tparam T An arithmetic type.
+   */
+  template<typename T>
+  std::optional<T> value(const std::uint32_t id) const noexcept
+  {
+    if (const auto chunk = find(id))
+      return chunk_value<T>(*chunk, byte_order_);
+    return std::nullopt;
+  }
+
+private:
+  const std::uint8_t* payload_{};
+  std::size_t size_{};
+  Byte_order byte_order_{Byte_order::little};
+};
+
+/**
+ * The IDs of the chunks of the frame metadata. The IDs are specified by the
+ * device description (the `ChunkID` of the nodes like `ChunkFrameID`). The
+ * zero ID means that the chunk is not used.
+ */
+struct Chunk_ids final {
+  std::uint32_t frame_id{};
+  std::uint32_t timestamp{};
+  std::uint32_t exposure_time{};
+  std::uint32_t gain{};
+  std::uint32_t counter_value{};
+};
+
+/// The metadata of the frame read from its chunks.
+struct Chunk_data final {
+  std::optional<std::uint64_t> frame_id;
+  std::optional<std::uint64_t> timestamp;
+  /// The exposure time, in microseconds.
+  std::optional<double> exposure_time;
+  /// The gain, in dB.
+  std::optional<double> gain;
+  std::optional<std::uint64_t> counter_value;
+};
+
+/// @returns The metadata of the frame read from the chunks of the `view`.
+inline Chunk_data chunk_data(const Chunk_view& view, const Chunk_ids& ids) noexcept
+{
+  Chunk_data result;
+  view.for_each([&](const Chunk& chunk)
+  {
+    const auto value = [&](auto& field)
+    {
+      using T = typename std::decay_t<decltype(field)>::value_type;
+      field = chunk_value<T>(chunk, view.byte_order());
+    };
+    if (!chunk.id)
+      return true;
+    else if (chunk.id == ids.frame_id)
+      value(result.frame_id);
+    else if (chunk.id == ids.timestamp)
+      value(result.timestamp);
+    else if (chunk.id == ids.exposure_time)
+      value(result.exposure_time);
+    else if (chunk.id == ids.gain)
+      value(result.gain);
+    else if (chunk.id == ids.counter_value)
+      value(result.counter_value);
+    return true;
+  });
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Class Frame_synchronizer
+// -----------------------------------------------------------------------------
+
+/**
+ * Matches the frames of several devices into sets of frames taken at the
+ * same instant.
+ *
+ * Each device has a ring buffer of a fixed capacity. The timestamps of the
+ * frames are normalized by using the time base of the corresponding device,
+ * so the frames of different devices are compared in a common time base.
+ * A set is matched when the heads of all the ring buffers are within the
+ * tolerance. Otherwise, the earliest head is discarded since it cannot be
+ * matched with any frame of the device whose head is the latest one.
+ *
+ * @remarks Thread-safe. Frames could be pushed right from capture callbacks.
+ */
+class Frame_synchronizer final {
+public:
+  /// The counters.
+  struct Stats final {
+    /// The number of matched sets.
+    std::uint64_t matched{};
+    /// The number of frames discarded because they have no partners.
+    std::uint64_t unmatched{};
+    /// The number of frames discarded because of the ring buffer overflow.
+    std::uint64_t dropped{};
+  };
+
+  /**
+   * The constructor.
+   *
+   * @param device_count The number of devices to synchronize.
+   * @param tolerance The maximum difference between the timestamps of frames
+   * of the same set.
+   * @param capacity The capacity of the ring buffer of each device.
+   *
+   * @par Requires
+   * `device_count > 0 && tolerance.count() >= 0 && capacity > 0`.
+   */
+  Frame_synchronizer(const std::size_t device_count,
+    const std::chrono::nanoseconds tolerance,
+    const std::size_t capacity = 8)
+    : tolerance_{tolerance.count()}
+    , rings_(device_count)
+  {
+    if (!device_count)
+      throw std::invalid_argument{"invalid device count"};
+    else if (tolerance_ < 0)
+      throw std::invalid_argument{"invalid synchronization tolerance"};
+    else if (!capacity)
+      throw std::invalid_argument{"invalid ring buffer capacity"};
+
+    for (auto& ring : rings_)
+      ring.entries.resize(capacity);
+  }
+
+  /// Non copy-constructible.
+  Frame_synchronizer(const Frame_synchronizer&) = delete;
+  /// Non copy-assignable.
+  Frame_synchronizer& operator=(const Frame_synchronizer&) = delete;
+  /// Non move-constructible.
+  Frame_synchronizer(Frame_synchronizer&&) = delete;
+  /// Non move-assignable.
+  Frame_synchronizer& operator=(Frame_synchronizer&&) = delete;
+
+  /// @returns The number of devices.
+  std::size_t device_count() const noexcept
+  {
+    return rings_.size();
+  }
+
+  /// @returns The synchronization tolerance.
+  std::chrono::nanoseconds tolerance() const noexcept
+  {
+    return std::chrono::nanoseconds{tolerance_};
+  }
+
+  /**
+   * Sets the time base of the device.
+   *
+   * @par Requires
+   * `device < device_count()`.
+   *
+   * @see Device::time_base().
+   */
+  void set_time_base(const std::size_t device, const Time_base& value)
+  {
+    check_device(device);
+    const std::lock_guard lg{mutex_};
+    rings_[device].time_base = value;
+  }
+
+  /**
+   * Pushes the frame of the device. If the ring buffer of the device is full,
+   * its oldest frame is dropped.
+   *
+   * @returns `false` if a frame has been dropped, or `true` otherwise.
+   *
+   * @par Requires
+   * `device < device_count()`.
+   */
+  bool push(const std::size_t device, Frame_data&& frame)
+  {
+    check_device(device);
+    const std::lock_guard lg{mutex_};
+    auto& ring = rings_[device];
+    const bool is_full = ring.size == ring.entries.size();
+    if (is_full) {
+      Frame_data dropped{std::move(ring.front().frame)};
+      ring.pop();
+      stats_.dropped++;
+    }
+    const auto time = ring.time_base.to_nanoseconds(frame.data.nTimestamp);
+    ring.push(time, std::move(frame));
+    return !is_full;
+  }
+
+  /**
+   * Matches the next set of frames.
+   *
+   * @param[out] result The set of frames ordered by device. The previous
+   * content of `result` is destroyed.
+   *
+   * @returns `true` if the set is matched, or `false` otherwise.
+   */
+  bool try_pop(std::vector<Frame_data>& result)
+  {
+    const std::lock_guard lg{mutex_};
+    while (true) {
+      std::int64_t min_time{};
+      std::int64_t max_time{};
+      std::size_t min_device{};
+      for (std::size_t i{}; i < rings_.size(); ++i) {
+        const auto& ring = rings_[i];
+        if (!ring.size)
+          return false;
+
+        const auto time = ring.front().time;
+        if (!i || time < min_time) {
+          min_time = time;
+          min_device = i;
+        }
+        if (!i || time > max_time)
+          max_time = time;
+      }
+
+      if (max_time - min_time <= tolerance_) {
+        result.clear();
+        result.reserve(rings_.size());
+        for (auto& ring : rings_) {
+          result.push_back(std::move(ring.front().frame));
+          ring.pop();
+        }
+        stats_.matched++;
+        return true;
+      }
+
+      auto& ring = rings_[min_device];
+      Frame_data unmatched{std::move(ring.front().frame)};
+      ring.pop();
+      stats_.unmatched++;
+    }
+  }
+
+  /// @returns The counters.
+  Stats stats() const
+  {
+    const std::lock_guard lg{mutex_};
+    return stats_;
+  }
+
+  /// Discards all the pending frames. (The counters are not affected.)
+  void clear()
+  {
+    const std::lock_guard lg{mutex_};
+    for (auto& ring : rings_) {
+      while (ring.size) {
+        Frame_data discarded{std::move(ring.front().frame)};
+        ring.pop();
+      }
+    }
+  }
+
+private:
+  struct Entry final {
+    std::int64_t time{};
+    Frame_data frame;
+  };
+
+  struct Ring final {
+    Time_base time_base;
+    std::vector<Entry> entries;
+    std::size_t head{};
+    std::size_t size{};
+
+    Entry& front() noexcept
+    {
+      return entries[head];
+    }
+
+    const Entry& front() const noexcept
+    {
+      return entries[head];
+    }
+
+    void push(const std::int64_t time, Frame_data&& frame) noexcept
+    {
+      auto& entry = entries[(head + size) % entries.size()];
+      entry.time = time;
+      entry.frame = std::move(frame); // the slot is always moved-from here
+      size++;
+    }
+
+    void pop() noexcept
+    {
+      head = (head + 1) % entries.size();
+      size--;
+    }
+  };
+
+  mutable std::mutex mutex_;
+  std::int64_t tolerance_{};
+  std::vector<Ring> rings_;
+  Stats stats_;
+
+  void check_device(const std::size_t device) const
+  {
+    if (!(device < rings_.size()))
+      throw std::out_of_range{"invalid device index"};
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Class Bounded_queue
+// -----------------------------------------------------------------------------
+
+/**
+ * A bounded lock-free multi-producer multi-consumer queue.
+ *
+ * Each cell has a sequence number which tells producers and consumers whether
+ * the cell is ready for them, so the only shared writes are the CAS on the
+ * enqueue or dequeue position.
+ *
+ * @tparam T The type of values. Must be default-constructible and
+ * move-assignable.
+ */
+template<typename T>
+class Bounded_queue final {
+public:
+  /**
+   * The constructor.
+   *
+   * @param capacity The capacity which is rounded up to the power of 2.
+   *
+   * @par Requires
+   * `capacity > 0`.
+   */
+  explicit Bounded_queue(const std::size_t capacity)
+  {
+    if (!capacity)
+      throw std::invalid_argument{"invalid queue capacity"};
+
+    std::size_t size{1};
+    while (size < capacity)
+      size <<= 1;
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (std::size_t i{}; i < size; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /// Non copy-constructible.
+  Bounded_queue(const Bounded_queue&) = delete;
+  /// Non copy-assignable.
+  Bounded_queue& operator=(const Bounded_queue&) = delete;
+  /// Non move-constructible.
+  Bounded_queue(Bounded_queue&&) = delete;
+  /// Non move-assignable.
+  Bounded_queue& operator=(Bounded_queue&&) = delete;
+
+  /// @returns The capacity.
+  std::size_t capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  /// @returns The approximate number of values in the queue.
+  std::size_t size_approx() const noexcept
+  {
+    const auto e = enqueue_pos_.load(std::memory_order_relaxed);
+    const auto d = dequeue_pos_.load(std::memory_order_relaxed);
+    return e > d ? e - d : 0;
+  }
+
+  /**
+   * Moves the `value` into the queue.
+   *
+   * @returns `false` if the queue is full (in which case `value` is left
+   * untouched), or `true` otherwise.
+   */
+  bool try_push(T& value) noexcept(std::is_nothrow_move_assignable_v<T>)
+  {
+    Cell* cell{};
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const auto seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (!diff) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0)
+        return false;
+      else
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @overload
+  bool try_push(T&& value) noexcept(std::is_nothrow_move_assignable_v<T>)
+  {
+    return try_push(value);
+  }
+
+  /**
+   * Moves the front value of the queue into `value`.
+   *
+   * @returns `false` if the queue is empty, or `true` otherwise.
+   */
+  bool try_pop(T& value) noexcept(std::is_nothrow_move_assignable_v<T>)
+  {
+    Cell* cell{};
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const auto seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (!diff) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0)
+        return false;
+      else
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+    value = std::move(cell->value);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  struct alignas(64) Cell final {
+    std::atomic<std::size_t> sequence{};
+    T value{};
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  std::size_t mask_{};
+  alignas(64) std::atomic<std::size_t> enqueue_pos_{};
+  alignas(64) std::atomic<std::size_t> dequeue_pos_{};
+};
+
+// -----------------------------------------------------------------------------
+// Class Shared_frame
+// -----------------------------------------------------------------------------
+
+/**
+ * A handle of the frame shared by several consumers (for example, a recorder,
+ * a preview and an analyzer) without copying.
+ *
+ * The reference counter is intrusive: it's stored in the node of Frame_pool
+ * together with the frame, so sharing requires no allocations. When the last
+ * handle is destroyed, the frame (with its buffer) returns to its pool.
+ *
+ * @remarks Copying and destroying of handles is thread-safe. The frame
+ * should be modified only while `use_count() == 1`.
+ */
+class Shared_frame final {
+public:
+  /// The destructor. Calls reset().
+  ~Shared_frame()
+  {
+    reset();
+  }
+
+  /// Constructs an empty handle.
+  Shared_frame() = default;
+
+  /// Copy-constructible. (Increments the reference counter.)
+  Shared_frame(const Shared_frame& rhs) noexcept
+    : node_{rhs.node_}
+  {
+    if (node_)
+      node_->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Copy-assignable.
+  Shared_frame& operator=(const Shared_frame& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Shared_frame tmp{rhs};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// Move-constructible.
+  Shared_frame(Shared_frame&& rhs) noexcept
+    : node_{rhs.node_}
+  {
+    rhs.node_ = {};
+  }
+
+  /// Move-assignable.
+  Shared_frame& operator=(Shared_frame&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Shared_frame tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// The swap operation.
+  void swap(Shared_frame& other) noexcept
+  {
+    std::swap(node_, other.node_);
+  }
+
+  /// @returns `true` if this handle refers to a frame.
+  explicit operator bool() const noexcept
+  {
+    return node_;
+  }
+
+  /**
+   * @returns The frame.
+   *
+   * @par Requires
+   * `bool(*this)`.
+   */
+  Frame_data& frame() noexcept
+  {
+    return node_->frame;
+  }
+
+  /// @overload
+  const Frame_data& frame() const noexcept
+  {
+    return node_->frame;
+  }
+
+  /// @returns The number of handles which refer to the frame.
+  std::uint32_t use_count() const noexcept
+  {
+    return node_ ? node_->refs.load(std::memory_order_acquire) : 0;
+  }
+
+  /**
+   * Releases the reference. If it's the last one, the frame returns to the
+   * pool.
+   */
+  void reset() noexcept
+  {
+    if (node_) {
+      if (node_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        node_->free_list->try_push(node_);
+      node_ = {};
+    }
+  }
+
+private:
+  friend class Frame_pool;
+
+  struct Node final {
+    std::atomic<std::uint32_t> refs{};
+    Frame_data frame;
+    Bounded_queue<Node*>* free_list{};
+  };
+
+  Node* node_{};
+
+  explicit Shared_frame(Node* const node) noexcept
+    : node_{node}
+  {}
+};
+
+// -----------------------------------------------------------------------------
+// Class Frame_pool
+// -----------------------------------------------------------------------------
+
+/**
+ * A fixed-size pool of frames with preallocated buffers which are shared by
+ * using Shared_frame.
+ *
+ * @warning The pool must outlive all the handles of its frames.
+ *
+ * @see Device::capture(Frame_data&, std::chrono::milliseconds).
+ */
+class Frame_pool final {
+public:
+  /**
+   * The constructor.
+   *
+   * @param size The number of frames.
+   * @param capacity The capacity of buffer of each frame (usually,
+   * `Device::payload_size()`).
+   * @param resource The memory resource to allocate buffers from.
+   *
+   * @par Requires
+   * `size > 0`.
+   */
+  Frame_pool(const std::size_t size, const std::size_t capacity,
+    std::pmr::memory_resource* const resource = {})
+    : size_{size}
+    , free_{size}
+  {
+    if (!size)
+      throw std::invalid_argument{"invalid frame pool size"};
+
+    nodes_.reset(new Shared_frame::Node[size]);
+    for (std::size_t i{}; i < size; ++i) {
+      auto& node = nodes_[i];
+      node.frame = Frame_data{capacity, resource};
+      node.free_list = &free_;
+      Shared_frame::Node* ptr = &node;
+      free_.try_push(ptr);
+    }
+  }
+
+  /// Non copy-constructible.
+  Frame_pool(const Frame_pool&) = delete;
+  /// Non copy-assignable.
+  Frame_pool& operator=(const Frame_pool&) = delete;
+  /// Non move-constructible.
+  Frame_pool(Frame_pool&&) = delete;
+  /// Non move-assignable.
+  Frame_pool& operator=(Frame_pool&&) = delete;
+
+  /// @returns The number of frames.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @returns The approximate number of frames which are not in use.
+  std::size_t available_approx() const noexcept
+  {
+    return free_.size_approx();
+  }
+
+  /**
+   * @returns The handle of the frame which is not in use, or an empty handle
+   * if all the frames are in use.
+   */
+  Shared_frame acquire() noexcept
+  {
+    Shared_frame::Node* node{};
+    if (!free_.try_pop(node))
+      return Shared_frame{};
+
+    node->refs.store(1, std::memory_order_relaxed);
+    return Shared_frame{node};
+  }
+
+private:
+  std::size_t size_{};
+  Bounded_queue<Shared_frame::Node*> free_;
+  std::unique_ptr<Shared_frame::Node[]> nodes_;
+};
+
+// -----------------------------------------------------------------------------
+// Class Frame_mailbox
+// -----------------------------------------------------------------------------
+
+/**
+ * Copies the complete frame passed to the capture callback into the buffer
+ * of the `frame` without allocations.
+ *
+ * @returns `false` if the frame is incomplete or doesn't fit into the buffer
+ * (in which case the `frame` is left untouched), or `true` otherwise.
+ */
+inline bool copy_complete_frame(const GX_FRAME_CALLBACK_PARAM& param,
+  Frame_data& frame) noexcept
+{
+  const auto size = static_cast<std::size_t>(param.nImgSize);
+  if (param.status != GX_FRAME_STATUS_SUCCESS || param.nImgSize < 0
+    || !frame.data.pImgBuf || size > frame.capacity)
+    return false;
+
+  std::memcpy(frame.data.pImgBuf, param.pImgBuf, size);
+  frame.data.nStatus = param.status;
+  frame.data.nWidth = param.nWidth;
+  frame.data.nHeight = param.nHeight;
+  frame.data.nPixelFormat = param.nPixelFormat;
+  frame.data.nImgSize = param.nImgSize;
+  frame.data.nFrameID = param.nFrameID;
+  frame.data.nTimestamp = param.nTimestamp;
+  frame.data.nOffsetX = param.nOffsetX;
+  frame.data.nOffsetY = param.nOffsetY;
+  return true;
+}
+
+/**
+ * A latest-frame mailbox (the lock-free triple buffer) to be filled by the
+ * capture callback.
+ *
+ * The producer (the thread of SDK) copies each complete frame into its back
+ * buffer and swaps it with the middle one, and the consumer swaps its front
+ * buffer with the middle one if it holds the frame which is not taken yet.
+ * Thus, the consumer always gets the most recent complete frame, both sides
+ * are wait-free, and the unread frames are overwritten without allocations.
+ *
+ * @par Example
+ * @code
+ * Frame_mailbox mailbox{device.payload_size()};
+ * device.set_capture_callback(Frame_mailbox::callback, &mailbox);
+ * device.start_acquisition();
+ * while (true) {
+ *   if (const auto* const frame = mailbox.try_take())
+ *     process(*frame);
+ * }
+ * @endcode
+ *
+ * @remarks There must be at most one producer and one consumer.
+ */
+class Frame_mailbox final {
+public:
+  /**
+   * The constructor.
+   *
+   * @param capacity The capacity of each of the three buffers (usually,
+   * `Device::payload_size()`). The frames of greater size are dropped.
+   * @param resource The memory resource to allocate buffers from.
+   */
+  explicit Frame_mailbox(const std::size_t capacity,
+    std::pmr::memory_resource* const resource = {})
+    : frames_{Frame_data{capacity, resource}, Frame_data{capacity, resource},
+        Frame_data{capacity, resource}}
+  {}
+
+  /// Non copy-constructible.
+  Frame_mailbox(const Frame_mailbox&) = delete;
+  /// Non copy-assignable.
+  Frame_mailbox& operator=(const Frame_mailbox&) = delete;
+  /// Non move-constructible.
+  Frame_mailbox(Frame_mailbox&&) = delete;
+  /// Non move-assignable.
+  Frame_mailbox& operator=(Frame_mailbox&&) = delete;
+
+  /**
+   * The capture callback to be registered with the pointer to the mailbox
+   * as the user parameter.
+   *
+   * @see Device::set_capture_callback().
+   */
+  static void GX_STDC callback(GX_FRAME_CALLBACK_PARAM* const param)
+  {
+    static_cast<Frame_mailbox*>(param->pUserParam)->put(*param);
+  }
+
+  /**
+   * Copies the frame into the mailbox, overwriting the frame which is not
+   * taken yet (if any). Incomplete frames and frames which don't fit into
+   * the buffers are dropped.
+   *
+   * @remarks Must be called by the producer only.
+   *
+   * @returns `true` if the frame is put into the mailbox.
+   */
+  bool put(const GX_FRAME_CALLBACK_PARAM& param) noexcept
+  {
+    if (!copy_complete_frame(param, frames_[back_])) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    const auto previous = middle_.exchange(back_ | fresh_bit, std::memory_order_acq_rel);
+    back_ = previous & index_mask;
+    put_count_.fetch_add(1, std::memory_order_relaxed);
+    if (previous & fresh_bit)
+      overwritten_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Takes the most recent frame if it's not taken yet.
+   *
+   * @remarks Must be called by the consumer only.
+   *
+   * @returns The pointer to the frame which is valid until the next call of
+   * this function, or `nullptr` if there is no new frame.
+   */
+  const Frame_data* try_take() noexcept
+  {
+    if (!(middle_.load(std::memory_order_relaxed) & fresh_bit))
+      return nullptr;
+
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask;
+    return &frames_[front_];
+  }
+
+  /**
+   * @returns The frame which is taken last, or the frame with zero
+   * `data.nImgSize` if no frame is taken yet.
+   *
+   * @remarks Must be called by the consumer only.
+   */
+  const Frame_data& front() const noexcept
+  {
+    return frames_[front_];
+  }
+
+  /// @returns `true` if there is the frame which is not taken yet.
+  bool has_new_frame() const noexcept
+  {
+    return middle_.load(std::memory_order_acquire) & fresh_bit;
+  }
+
+  /// @returns The number of frames put into the mailbox.
+  std::uint64_t put_count() const noexcept
+  {
+    return put_count_.load(std::memory_order_relaxed);
+  }
+
+  /// @returns The number of frames overwritten before they were taken.
+  std::uint64_t overwritten_count() const noexcept
+  {
+    return overwritten_count_.load(std::memory_order_relaxed);
+  }
+
+  /// @returns The number of dropped (incomplete or oversized) frames.
+  std::uint64_t dropped_count() const noexcept
+  {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr unsigned index_mask{3};
+  static constexpr unsigned fresh_bit{4};
+
+  std::array<Frame_data, 3> frames_;
+  alignas(64) std::atomic<unsigned> middle_{1};
+  alignas(64) unsigned back_{2}; // owned by the producer
+  std::atomic<std::uint64_t> put_count_{};
+  std::atomic<std::uint64_t> overwritten_count_{};
+  std::atomic<std::uint64_t> dropped_count_{};
+  alignas(64) unsigned front_{}; // owned by the consumer
+};
+
+// -----------------------------------------------------------------------------
+// Class Frame_channel
+// -----------------------------------------------------------------------------
+
+/**
+ * A channel of frames from the capture callback to the event loop (based on
+ * `epoll`, `poll` or `select`) which can't block in Device::capture().
+ *
+ * The capture callback copies each complete frame into the frame of the pool
+ * and pushes it into the lock-free queue. The file descriptor returned by
+ * fd() becomes readable when the queue becomes non-empty, so many devices
+ * and sockets can be multiplexed on one thread without polling. (The
+ * descriptor is signaled once per transition to the non-empty state rather
+ * than once per frame, so the capture thread rarely makes a syscall.)
+ *
+ * @par Example
+ * @code
+ * Frame_channel channel{4, device.payload_size()};
+ * device.set_capture_callback(Frame_channel::callback, &channel);
+ * epoll_event event{EPOLLIN, {.ptr = &channel}};
+ * epoll_ctl(epoll, EPOLL_CTL_ADD, channel.fd(), &event);
+ * // ... when the fd is readable:
+ * for (Shared_frame frame; channel.try_pop(frame);)
+ *   process(frame.frame());
+ * @endcode
+ *
+ * @remarks There must be at most one producer and one consumer.
+ *
+ * @remarks The descriptor is an `eventfd` which is available on Linux only.
+ * On other systems fd() returns `-1` and the consumer must poll try_pop().
+ */
+class Frame_channel final {
+public:
+  /// The destructor. Closes the descriptor.
+  ~Frame_channel()
+  {
+#ifdef __linux__
+    if (fd_ >= 0)
+      close(fd_);
+#endif
+  }
+
+  /**
+   * The constructor.
+   *
+   * @param size The number of frames which can be pending or in use by the
+   * consumer. When all of them are in use, new frames are dropped.
+   * @param capacity The capacity of buffer of each frame (usually,
+   * `Device::payload_size()`).
+   * @param resource The memory resource to allocate buffers from.
+   */
+  Frame_channel(const std::size_t size, const std::size_t capacity,
+    std::pmr::memory_resource* const resource = {})
+    : pool_{size, capacity, resource}
+    , queue_{size}
+  {
+#ifdef __linux__
+    fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd_ < 0)
+      throw std::system_error{errno, std::system_category(), "eventfd()"};
+#endif
+  }
+
+  /// Non copy-constructible.
+  Frame_channel(const Frame_channel&) = delete;
+  /// Non copy-assignable.
+  Frame_channel& operator=(const Frame_channel&) = delete;
+  /// Non move-constructible.
+  Frame_channel(Frame_channel&&) = delete;
+  /// Non move-assignable.
+  Frame_channel& operator=(Frame_channel&&) = delete;
+
+  /**
+   * The capture callback to be registered with the pointer to the channel
+   * as the user parameter.
+   *
+   * @see Device::set_capture_callback().
+   */
+  static void GX_STDC callback(GX_FRAME_CALLBACK_PARAM* const param)
+  {
+    static_cast<Frame_channel*>(param->pUserParam)->put(*param);
+  }
+
+  /**
+   * @returns The descriptor which is readable when there are frames to pop,
+   * or `-1` on systems other than Linux.
+   */
+  int fd() const noexcept
+  {
+    return fd_;
+  }
+
+  /**
+   * Copies the frame into the channel and signals the descriptor if the
+   * channel was empty. Incomplete frames, frames which don't fit into the
+   * buffers and frames which arrive when all the frames of the pool are in
+   * use are dropped.
+   *
+   * @remarks Must be called by the producer only.
+   *
+   * @returns `true` if the frame is put into the channel.
+   */
+  bool put(const GX_FRAME_CALLBACK_PARAM& param) noexcept
+  {
+    auto frame = pool_.acquire();
+    if (!frame || !copy_complete_frame(param, frame.frame())) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    queue_.try_push(frame); // never fails since the queue can hold the pool
+    put_count_.fetch_add(1, std::memory_order_relaxed);
+    if (!is_signaled_.exchange(true, std::memory_order_acq_rel)) {
+#ifdef __linux__
+      const std::uint64_t one{1};
+      [[maybe_unused]] const auto n = write(fd_, &one, sizeof(one));
+#endif
+    }
+    return true;
+  }
+
+  /**
+   * Pops the oldest pending frame. If the channel is empty, the descriptor
+   * is reset, so it becomes readable again only when a new frame arrives.
+   *
+   * @remarks Must be called by the consumer only.
+   *
+   * @returns `false` if the channel is empty, or `true` otherwise.
+   */
+  bool try_pop(Shared_frame& frame) noexcept
+  {
+    if (queue_.try_pop(frame))
+      return true;
+
+#ifdef __linux__
+    std::uint64_t value{};
+    [[maybe_unused]] const auto n = read(fd_, &value, sizeof(value));
+#endif
+    is_signaled_.exchange(false, std::memory_order_acq_rel);
+    // The frame could be pushed before the reset without signaling.
+    return queue_.try_pop(frame);
+  }
+
+  /// @returns The number of frames put into the channel.
+  std::uint64_t put_count() const noexcept
+  {
+    return put_count_.load(std::memory_order_relaxed);
+  }
+
+  /// @returns The number of dropped (incomplete, oversized or excess) frames.
+  std::uint64_t dropped_count() const noexcept
+  {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  Frame_pool pool_;
+  Bounded_queue<Shared_frame> queue_;
+  int fd_{-1};
+  std::atomic<bool> is_signaled_{};
+  std::atomic<std::uint64_t> put_count_{};
+  std::atomic<std::uint64_t> dropped_count_{};
+};
+
+// -----------------------------------------------------------------------------
+// Class Pipeline
+// -----------------------------------------------------------------------------
+
+/// A policy of pushing into the full queue of a pipeline stage.
+enum class Overflow_policy {
+  /// Wait until the queue has room (backpressure).
+  block,
+  /// Drop the value being pushed.
+  drop_newest,
+  /// Drop the oldest value of the queue.
+  drop_oldest
+};
+
+/**
+ * A staged processing pipeline (for example, capture, convert, analyze, sink).
+ *
+ * Each stage has its own bounded lock-free input queue and the configurable
+ * number of worker threads. Values which are processed by the last stage, or
+ * dropped or failed by any stage, are moved into the recycle queue, so the
+ * producer can reuse them (and their buffers) by calling acquire().
+ *
+ * @tparam T The type of values. Must be default-constructible and
+ * move-assignable.
+ *
+ * @remarks The order of values is not preserved by the stages which have
+ * more than one worker.
+ */
+template<typename T>
+class Pipeline final {
+public:
+  /**
+   * The stage function. Returning `false` drops the value (it's not passed
+   * to the next stage but recycled). Throwing an exception fails the value:
+   * it's recycled too, but counted as failed and reported to the error
+   * handler of the stage.
+   */
+  using Function = std::function<bool(T&)>;
+
+  /**
+   * The error handler of the stage. It's called by the worker thread with the
+   * stage index and the exception thrown by the stage function or by pinning
+   * of the worker thread to the NUMA node.
+   *
+   * @warning Must not throw.
+   */
+  using Error_handler = std::function<void(std::size_t, std::exception_ptr)>;
+
+  /// The stage options.
+  struct Stage_options final {
+    /// The name of the stage.
+    std::string name;
+    /// The number of worker threads.
+    std::size_t parallelism{1};
+    /// The capacity of the input queue.
+    std::size_t queue_capacity{8};
+    /// The policy of pushing into the full input queue.
+    Overflow_policy overflow_policy{Overflow_policy::block};
+    /// The NUMA node to pin the worker threads to, or `-1`.
+    int numa_node{-1};
+    /// The error handler. (Errors are only counted if not set.)
+    Error_handler error_handler{};
+  };
+
+  /// The stage metrics.
+  struct Stage_stats final {
+    /// The number of processed values.
+    std::uint64_t processed{};
+    /// The number of values dropped by the overflow policy or the function.
+    std::uint64_t dropped{};
+    /// The number of values the function has thrown on.
+    std::uint64_t failed{};
+    /// The number of processed values per second since start().
+    double throughput{};
+    /// The average time spent in the function.
+    std::chrono::nanoseconds average_service_time{};
+    /// The average time since enqueueing until the end of processing.
+    std::chrono::nanoseconds average_latency{};
+    /// The maximum time since enqueueing until the end of processing.
+    std::chrono::nanoseconds max_latency{};
+  };
+
+  /**
+   * The destructor. Calls stop().
+   *
+   * @warning Must not be called by a worker thread of the pipeline.
+   */
+  ~Pipeline()
+  {
+    stop();
+  }
+
+  /**
+   * The constructor.
+   *
+   * @param recycle_capacity The capacity of the recycle queue.
+   */
+  explicit Pipeline(const std::size_t recycle_capacity = 16)
+    : recycled_{recycle_capacity}
+  {}
+
+  /// Non copy-constructible.
+  Pipeline(const Pipeline&) = delete;
+  /// Non copy-assignable.
+  Pipeline& operator=(const Pipeline&) = delete;
+  /// Non move-constructible.
+  Pipeline(Pipeline&&) = delete;
+  /// Non move-assignable.
+  Pipeline& operator=(Pipeline&&) = delete;
+
+  /**
+   * Appends the stage.
+   *
+   * @par Requires
+   * `!is_running() && options.parallelism > 0 && function`.
+   */
+  void add_stage(Stage_options options, Function function)
+  {
+    if (is_running())
+      throw std::logic_error{"cannot add stage to running pipeline"};
+    else if (!options.parallelism)
+      throw std::invalid_argument{"invalid stage parallelism"};
+    else if (!function)
+      throw std::invalid_argument{"invalid stage function"};
+
+    stages_.push_back(std::make_unique<Stage>(std::move(options),
+        std::move(function)));
+  }
+
+  /// @returns The number of stages.
+  std::size_t stage_count() const noexcept
+  {
+    return stages_.size();
+  }
+
+  /// @returns `true` if the pipeline is running.
+  bool is_running() const noexcept
+  {
+    return is_running_;
+  }
+
+  /**
+   * Starts the worker threads of all the stages.
+   *
+   * @par Requires
+   * `stage_count() > 0`.
+   */
+  void start()
+  {
+    if (is_running_)
+      return;
+    else if (stages_.empty())
+      throw std::logic_error{"cannot start pipeline without stages"};
+
+    started_ = std::chrono::steady_clock::now();
+    is_running_ = true;
+    for (std::size_t i{}; i < stages_.size(); ++i) {
+      auto& stage = *stages_[i];
+      stage.is_stopping = false;
+      for (std::size_t j{}; j < stage.options.parallelism; ++j)
+        stage.workers.emplace_back(&Pipeline::run, this, i);
+    }
+  }
+
+  /**
+   * Drains and stops the stages one after another, starting from the first
+   * one.
+   *
+   * @warning Must not be called concurrently with push().
+   *
+   * @remarks Idempotent.
+   *
+   * @throws `std::logic_error` if called by a worker thread of the pipeline
+   * (e.g. from a stage function or an error handler), which can't join
+   * itself.
+   */
+  void stop()
+  {
+    if (!is_running_)
+      return;
+    else if (current_pipeline_ == this)
+      throw std::logic_error{"cannot stop pipeline from its worker thread"};
+
+    for (auto& stage : stages_) {
+      stage->is_stopping = true;
+      stage->wake_all();
+      for (auto& worker : stage->workers)
+        worker.join();
+      stage->workers.clear();
+    }
+    is_running_ = false;
+  }
+
+  /**
+   * Pushes the `value` into the input queue of the first stage according to
+   * its overflow policy.
+   *
+   * @returns `false` if a value has been dropped, or `true` otherwise.
+   *
+   * @par Requires
+   * `is_running()`.
+   */
+  bool push(T&& value)
+  {
+    if (!is_running_)
+      throw std::logic_error{"cannot push into stopped pipeline"};
+
+    return enqueue(*stages_.front(), std::move(value));
+  }
+
+  /**
+   * Moves a recycled value into `value`.
+   *
+   * @returns `false` if there are no recycled values, or `true` otherwise.
+   */
+  bool acquire(T& value)
+  {
+    return recycled_.try_pop(value);
+  }
+
+  /**
+   * Moves the `value` into the recycle queue. If the queue is full, the
+   * `value` is destroyed.
+   */
+  void recycle(T&& value)
+  {
+    if (!recycled_.try_push(value))
+      [[maybe_unused]] T destroyed{std::move(value)};
+  }
+
+  /**
+   * @returns The metrics of the stage.
+   *
+   * @par Requires
+   * `stage < stage_count()`.
+   */
+  Stage_stats stats(const std::size_t stage) const
+  {
+    if (!(stage < stages_.size()))
+      throw std::out_of_range{"invalid pipeline stage index"};
+
+    using std::chrono::nanoseconds;
+    const auto& s = *stages_[stage];
+    Stage_stats result;
+    result.processed = s.processed.load(std::memory_order_relaxed);
+    result.dropped = s.dropped.load(std::memory_order_relaxed);
+    result.failed = s.failed.load(std::memory_order_relaxed);
+    if (result.processed) {
+      const auto n = static_cast<std::int64_t>(result.processed);
+      result.average_service_time = nanoseconds{s.service_ns.load(std::memory_order_relaxed) / n};
+      result.average_latency = nanoseconds{s.latency_ns.load(std::memory_order_relaxed) / n};
+    }
+    result.max_latency = nanoseconds{s.max_latency_ns.load(std::memory_order_relaxed)};
+    if (is_running_) {
+      const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - started_};
+      if (elapsed.count() > 0)
+        result.throughput = static_cast<double>(result.processed) / elapsed.count();
+    }
+    return result;
+  }
+
+  /// @returns The name of the stage.
+  const std::string& stage_name(const std::size_t stage) const
+  {
+    if (!(stage < stages_.size()))
+      throw std::out_of_range{"invalid pipeline stage index"};
+    return stages_[stage]->options.name;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Envelope final {
+    T value{};
+    Clock::time_point enqueued;
+  };
+
+  struct Stage final {
+    Stage(Stage_options options, Function function)
+      : options{std::move(options)}
+      , function{std::move(function)}
+      , queue{this->options.queue_capacity}
+    {}
+
+    Stage_options options;
+    Function function;
+    Bounded_queue<Envelope> queue;
+    std::vector<std::thread> workers;
+    std::atomic_bool is_stopping{};
+
+    // Parking of idle workers.
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic_int waiters{};
+
+    // Metrics.
+    std::atomic<std::uint64_t> processed{};
+    std::atomic<std::uint64_t> dropped{};
+    std::atomic<std::uint64_t> failed{};
+    std::atomic<std::int64_t> service_ns{};
+    std::atomic<std::int64_t> latency_ns{};
+    std::atomic<std::int64_t> max_latency_ns{};
+
+    void wake_one()
+    {
+      /*
+       * Pairs with the fence of the parking worker: either it sees the value
+       * just pushed, or this thread sees it waiting.
+       */
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters.load(std::memory_order_relaxed)) {
+        const std::lock_guard lg{mutex};
+        cv.notify_one();
+      }
+    }
+
+    void wake_all()
+    {
+      const std::lock_guard lg{mutex};
+      cv.notify_all();
+    }
+
+    void report(const std::size_t index, std::exception_ptr error) const noexcept
+    {
+      if (options.error_handler)
+        options.error_handler(index, std::move(error));
+    }
+  };
+
+  inline static thread_local const Pipeline* current_pipeline_{};
+
+  std::vector<std::unique_ptr<Stage>> stages_;
+  Bounded_queue<T> recycled_;
+  std::atomic_bool is_running_{};
+  Clock::time_point started_;
+
+  bool enqueue(Stage& stage, T&& value)
+  {
+    Envelope envelope{std::move(value), Clock::now()};
+    bool result{true};
+    for (unsigned spins{}; !stage.queue.try_push(envelope);) {
+      switch (stage.options.overflow_policy) {
+      case Overflow_policy::block:
+        if (++spins < 64)
+          std::this_thread::yield();
+        else
+          std::this_thread::sleep_for(std::chrono::microseconds{50});
+        continue;
+      case Overflow_policy::drop_newest:
+        stage.dropped.fetch_add(1, std::memory_order_relaxed);
+        recycle(std::move(envelope.value));
+        return false;
+      case Overflow_policy::drop_oldest:
+        if (Envelope oldest; stage.queue.try_pop(oldest)) {
+          stage.dropped.fetch_add(1, std::memory_order_relaxed);
+          recycle(std::move(oldest.value));
+          result = false;
+        }
+        continue;
+      }
+    }
+    stage.wake_one();
+    return result;
+  }
+
+  void run(const std::size_t index)
+  {
+    current_pipeline_ = this;
+    auto& stage = *stages_[index];
+    try {
+      pin_current_thread_to_numa_node(stage.options.numa_node);
+    } catch (...) {
+      stage.report(index, std::current_exception());
+    }
+    Stage* const next = index + 1 < stages_.size() ? stages_[index + 1].get() : nullptr;
+    Envelope envelope;
+    unsigned idle{};
+    while (true) {
+      if (!stage.queue.try_pop(envelope)) {
+        if (stage.is_stopping)
+          break;
+        else if (++idle < 64) {
+          std::this_thread::yield();
+          continue;
+        }
+
+        std::unique_lock lk{stage.mutex};
+        stage.waiters++;
+        std::atomic_thread_fence(std::memory_order_seq_cst); // see wake_one()
+        // The timeout is only a safety net.
+        if (!stage.queue.size_approx() && !stage.is_stopping)
+          stage.cv.wait_for(lk, std::chrono::milliseconds{10});
+        stage.waiters--;
+        continue;
+      }
+      idle = 0;
+
+      const auto started = Clock::now();
+      bool is_passed{};
+      std::exception_ptr error;
+      try {
+        is_passed = stage.function(envelope.value);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      const auto finished = Clock::now();
+
+      using std::chrono::duration_cast;
+      using std::chrono::nanoseconds;
+      const auto service = duration_cast<nanoseconds>(finished - started).count();
+      const auto latency = duration_cast<nanoseconds>(finished - envelope.enqueued).count();
+      stage.service_ns.fetch_add(service, std::memory_order_relaxed);
+      stage.latency_ns.fetch_add(latency, std::memory_order_relaxed);
+      for (auto max = stage.max_latency_ns.load(std::memory_order_relaxed);
+           latency > max && !stage.max_latency_ns.compare_exchange_weak(max, latency,
+             std::memory_order_relaxed);){}
+      stage.processed.fetch_add(1, std::memory_order_relaxed);
+
+      if (error) {
+        stage.failed.fetch_add(1, std::memory_order_relaxed);
+        recycle(std::move(envelope.value));
+        stage.report(index, std::move(error));
+      } else if (!is_passed) {
+        stage.dropped.fetch_add(1, std::memory_order_relaxed);
+        recycle(std::move(envelope.value));
+      } else if (next)
+        enqueue(*next, std::move(envelope.value));
+      else
+        recycle(std::move(envelope.value));
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Class Thread_pool
+// -----------------------------------------------------------------------------
+
+/**
+ * A work-stealing thread pool which is intended to be shared by all the
+ * devices.
+ *
+ * Each worker has its own deque of tasks. Tasks submitted from a worker are
+ * pushed to its own deque, other tasks are distributed round-robin. A worker
+ * takes tasks from the back of its own deque and, when it's empty, steals
+ * tasks from the front of the deques of other workers, so quiet devices
+ * don't leave workers idle while bursty ones overload them.
+ *
+ * @see Sequencer.
+ */
+class Thread_pool final {
+public:
+  /// The task.
+  using Task = std::function<void()>;
+
+  /**
+   * The error handler of the pool. It's called by the worker thread with the
+   * exception thrown by the task or by pinning of the worker thread to the
+   * NUMA node.
+   *
+   * @warning Must not throw.
+   */
+  using Error_handler = std::function<void(std::exception_ptr)>;
+
+  /// The destructor. Runs the pending tasks and joins the workers.
+  ~Thread_pool()
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_)
+      worker->thread.join();
+  }
+
+  /**
+   * The constructor.
+   *
+   * @param size The number of workers. `0` means the number of hardware
+   * threads (or the number of CPUs of the `numa_node` if it's specified).
+   * @param numa_node The NUMA node to pin the workers to, or `-1`.
+   * @param error_handler The error handler. (Errors are only counted if not
+   * set.)
+   */
+  explicit Thread_pool(std::size_t size = 0, const int numa_node = -1,
+    Error_handler error_handler = {})
+    : numa_node_{numa_node}
+    , error_handler_{std::move(error_handler)}
+  {
+    if (!size) {
+      const auto cpus = numa_node_cpus(numa_node);
+      size = !cpus.empty() ? cpus.size() :
+        std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    workers_.reserve(size);
+    for (std::size_t i{}; i < size; ++i)
+      workers_.push_back(std::make_unique<Worker>());
+    for (std::size_t i{}; i < size; ++i)
+      workers_[i]->thread = std::thread{&Thread_pool::run, this, i};
+  }
+
+  /// Non copy-constructible.
+  Thread_pool(const Thread_pool&) = delete;
+  /// Non copy-assignable.
+  Thread_pool& operator=(const Thread_pool&) = delete;
+  /// Non move-constructible.
+  Thread_pool(Thread_pool&&) = delete;
+  /// Non move-assignable.
+  Thread_pool& operator=(Thread_pool&&) = delete;
+
+  /// @returns The number of workers.
+  std::size_t size() const noexcept
+  {
+    return workers_.size();
+  }
+
+  /**
+   * @returns The number of errors: exceptions thrown by tasks and failures
+   * to pin the workers to the NUMA node.
+   */
+  std::uint64_t failed() const noexcept
+  {
+    return failed_.load(std::memory_order_relaxed);
+  }
+
+  /// Submits the `task` for execution.
+  void submit(Task task)
+  {
+    const auto index = current_pool_ == this ? current_index_ :
+      next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+      auto& worker = *workers_[index];
+      const std::lock_guard lg{worker.mutex};
+      worker.tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1);
+    if (sleepers_.load()) {
+      const std::lock_guard lg{mutex_};
+      cv_.notify_one();
+    }
+  }
+
+  /**
+   * Calls `f(i)` for each `i` in range `[0, count)` by using the workers and
+   * the calling thread, and waits for the completion. This is useful to
+   * split a frame into tiles.
+   *
+   * @throws The first exception thrown by `f`.
+   */
+  template<typename F>
+  void parallel_for(const std::size_t count, F&& f)
+  {
+    if (!count)
+      return;
+
+    struct State final {
+      std::atomic<std::size_t> next{};
+      std::atomic<std::size_t> done{};
+      std::mutex mutex;
+      std::exception_ptr exception;
+    };
+    const auto state = std::make_shared<State>();
+    const auto body = [state, count, &f]
+    {
+      for (std::size_t i; (i = state->next.fetch_add(1)) < count;) {
+        try {
+          f(i);
+        } catch (...) {
+          const std::lock_guard lg{state->mutex};
+          if (!state->exception)
+            state->exception = std::current_exception();
+        }
+        state->done.fetch_add(1, std::memory_order_release);
+      }
+    };
+
+    const auto helpers = std::min(count, workers_.size()) - 1;
+    for (std::size_t i{}; i < helpers; ++i)
+      submit(body);
+    body();
+    while (state->done.load(std::memory_order_acquire) < count)
+      std::this_thread::yield();
+
+    if (state->exception)
+      std::rethrow_exception(state->exception);
+  }
+
+private:
+  struct alignas(64) Worker final {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+  };
+
+  inline static thread_local Thread_pool* current_pool_{};
+  inline static thread_local std::size_t current_index_{};
+
+  int numa_node_{-1};
+  Error_handler error_handler_;
+  alignas(64) std::atomic<std::uint64_t> failed_{};
+  std::vector<std::unique_ptr<Worker>> workers_;
+  alignas(64) std::atomic<std::size_t> next_worker_{};
+  alignas(64) std::atomic<std::size_t> pending_{};
+  std::atomic<std::size_t> sleepers_{};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool is_stopping_{};
+
+  bool pop(const std::size_t index, Task& task)
+  {
+    auto& worker = *workers_[index];
+    const std::lock_guard lg{worker.mutex};
+    if (worker.tasks.empty())
+      return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+  }
+
+  bool steal(const std::size_t index, Task& task)
+  {
+    const auto size = workers_.size();
+    for (std::size_t i{1}; i < size; ++i) {
+      auto& victim = *workers_[(index + i) % size];
+      const std::unique_lock lk{victim.mutex, std::try_to_lock};
+      if (lk && !victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(const std::size_t index)
+  {
+    current_pool_ = this;
+    current_index_ = index;
+    try {
+      pin_current_thread_to_numa_node(numa_node_);
+    } catch (...) {
+      report(std::current_exception());
+    }
+    Task task;
+    while (true) {
+      if (pop(index, task) || steal(index, task)) {
+        pending_.fetch_sub(1);
+        try {
+          task();
+        } catch (...) {
+          report(std::current_exception());
+        }
+        task = nullptr;
+        continue;
+      } else if (pending_.load()) {
+        // Some deque is busy (try_lock failed) or a task is being pushed.
+        std::this_thread::yield();
+        continue;
+      }
+
+      std::unique_lock lk{mutex_};
+      sleepers_.fetch_add(1);
+      cv_.wait(lk, [this]{ return pending_.load() || is_stopping_; });
+      sleepers_.fetch_sub(1);
+      if (is_stopping_ && !pending_.load())
+        break;
+    }
+  }
+
+  void report(std::exception_ptr error) noexcept
+  {
+    failed_.fetch_add(1, std::memory_order_relaxed);
+    if (error_handler_)
+      error_handler_(std::move(error));
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Class Sequencer
+// -----------------------------------------------------------------------------
+
+/**
+ * Restores the order of results which are produced out of order (for
+ * example, by the jobs of Thread_pool).
+ *
+ * Typical usage is one instance per device:
+ *   -# assign a sequence number to each frame with next_sequence();
+ *   -# submit the conversion job to the shared Thread_pool;
+ *   -# call complete() (or skip()) from the job.
+ *
+ * The sink is called with the results strictly in the order of sequence
+ * numbers and never concurrently. It's called by the thread which happens to
+ * complete the job the delivery is waiting for, so the exception thrown by the
+ * sink is propagated out of complete() (or skip()) of that thread rather than
+ * of the thread which completed the job of the failed result. The failed
+ * result is lost, the delivery of the rest ones is continued by the next call
+ * of complete() (or skip()).
+ *
+ * The number of pending results is limited by the maximum window. If the job
+ * is completed too far ahead of the oldest pending sequence number (for
+ * example, because the job of the latter has never called complete() nor
+ * skip()), the missing results at the head of the window are considered lost:
+ * the results which follow them are delivered, and the results of the lost
+ * sequence numbers are discarded when completed later.
+ *
+ * @tparam T The type of results. Must be move-constructible.
+ */
+template<typename T>
+class Sequencer final {
+public:
+  /// The sink of the ordered results.
+  using Sink = std::function<void(std::uint64_t sequence, T&& result)>;
+
+  /**
+   * The constructor.
+   *
+   * @param sink The sink of the ordered results.
+   * @param window The initial number of results which could be pending.
+   * (Grows on demand up to `max_window`.)
+   * @param max_window The maximum number of results which could be pending.
+   * It's rounded up to the power of 2.
+   *
+   * @par Requires
+   * `sink && window <= max_window`.
+   */
+  explicit Sequencer(Sink sink, const std::size_t window = 16,
+    const std::size_t max_window = 1024)
+    : sink_{std::move(sink)}
+  {
+    if (!sink_)
+      throw std::invalid_argument{"invalid sequencer sink"};
+    else if (!(window <= max_window))
+      throw std::invalid_argument{"invalid sequencer window"};
+
+    std::size_t size{1};
+    while (size < window)
+      size <<= 1;
+    slots_.resize(size);
+    while (size < max_window)
+      size <<= 1;
+    max_window_ = size;
+  }
+
+  /// Non copy-constructible.
+  Sequencer(const Sequencer&) = delete;
+  /// Non copy-assignable.
+  Sequencer& operator=(const Sequencer&) = delete;
+  /// Non move-constructible.
+  Sequencer(Sequencer&&) = delete;
+  /// Non move-assignable.
+  Sequencer& operator=(Sequencer&&) = delete;
+
+  /// @returns The next sequence number.
+  std::uint64_t next_sequence() noexcept
+  {
+    return issued_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Completes the job of the given `sequence` number with `result`.
+   *
+   * @returns `false` if the `sequence` is lost (in which case the `result`
+   * is discarded), or `true` otherwise.
+   *
+   * @par Requires
+   * The `sequence` is not completed yet.
+   *
+   * @remarks May block while the sink is delivering the results if the
+   * maximum window is exhausted. Thus, the sink must not call this function.
+   */
+  bool complete(const std::uint64_t sequence, T&& result)
+  {
+    return put(sequence, std::optional<T>{std::move(result)});
+  }
+
+  /**
+   * Completes the job of the given `sequence` number without result.
+   *
+   * @returns `false` if the `sequence` is lost, or `true` otherwise.
+   *
+   * @par Requires
+   * The `sequence` is not completed yet.
+   *
+   * @remarks May block as complete().
+   */
+  bool skip(const std::uint64_t sequence)
+  {
+    return put(sequence, std::nullopt);
+  }
+
+  /// @returns The number of sequence numbers lost due to the maximum window.
+  std::uint64_t lost_count() const noexcept
+  {
+    return lost_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Slot final {
+    bool is_done{};
+    std::optional<T> result;
+  };
+
+  Sink sink_;
+  std::atomic<std::uint64_t> issued_{};
+  std::atomic<std::uint64_t> lost_{};
+  std::mutex mutex_;
+  std::condition_variable delivered_;
+  std::vector<Slot> slots_;
+  std::size_t max_window_{};
+  std::uint64_t next_{};
+  bool is_draining_{};
+
+  bool put(const std::uint64_t sequence, std::optional<T>&& result)
+  {
+    std::unique_lock lk{mutex_};
+    while (true) {
+      // Either delivered or lost. (Both can't be distinguished.)
+      if (sequence < next_)
+        return false;
+      else if (sequence - next_ < slots_.size())
+        break;
+      else if (slots_.size() < max_window_)
+        grow();
+      else if (is_draining_)
+        delivered_.wait(lk);
+      else
+        drain(lk, sequence - slots_.size() + 1);
+    }
+    auto& slot = slots_[sequence & (slots_.size() - 1)];
+    if (slot.is_done)
+      throw std::invalid_argument{"sequence number is already completed"};
+    slot.is_done = true;
+    slot.result = std::move(result);
+
+    if (!is_draining_)
+      drain(lk, next_);
+    return true;
+  }
+
+  /**
+   * Delivers the completed results at the head of the window. The missing
+   * ones are considered lost until `lost_until`.
+   *
+   * @par Requires
+   * `!is_draining_`.
+   */
+  void drain(std::unique_lock<std::mutex>& lk, const std::uint64_t lost_until)
+  {
+    // Only one thread delivers the results at a time, without the lock.
+    is_draining_ = true;
+    while (true) {
+      auto& head = slots_[next_ & (slots_.size() - 1)];
+      if (!head.is_done) {
+        if (next_ < lost_until) {
+          lost_.fetch_add(1, std::memory_order_relaxed);
+          next_++;
+          continue;
+        } else
+          break;
+      }
+
+      auto value = std::move(head.result);
+      head = Slot{};
+      const auto seq = next_++;
+      if (value) {
+        lk.unlock();
+        try {
+          sink_(seq, std::move(*value));
+        } catch (...) {
+          lk.lock();
+          is_draining_ = false;
+          delivered_.notify_all();
+          throw;
+        }
+        lk.lock();
+        delivered_.notify_all();
+      }
+    }
+    is_draining_ = false;
+    delivered_.notify_all();
+  }
+
+  void grow()
+  {
+    const auto old_size = slots_.size();
+    std::vector<Slot> slots(old_size * 2);
+    for (std::size_t i{}; i < old_size; ++i) {
+      const auto seq = next_ + i;
+      slots[seq & (slots.size() - 1)] = std::move(slots_[seq & (old_size - 1)]);
+    }
+    slots_.swap(slots);
+  }
+};
+
+namespace img {
+
+inline void throw_if_error(const VxInt32 s)
+{
+  switch (s) {
+  case DX_OK: return;
+  case DX_PARAMETER_INVALID:
+    throw std::runtime_error{"invalid input parameter"};
+  case DX_PARAMETER_OUT_OF_BOUND:
+    throw std::runtime_error{"the parameter is out of bound"};
+  case DX_NOT_ENOUGH_SYSTEM_MEMORY:
+    throw std::bad_alloc{};
+  case DX_NOT_FIND_DEVICE:
+    throw std::runtime_error{"no device found"};
+  case DX_STATUS_NOT_SUPPORTED:
+    throw std::runtime_error{"the format is not supported"};
+  case DX_CPU_NOT_SUPPORT_ACCELERATE:
+    throw std::runtime_error{"the CPU does not support acceleration"};
+  default:
+    throw std::runtime_error{"unknown error"};
+  }
+}
+
+template<typename F, typename ... Types>
+inline void call(F&& f, Types&& ... args)
+{
+  throw_if_error(f(std::forward<Types>(args)...));
+}
+
+inline std::unique_ptr<unsigned char[]> raw8_to_rgb24(
+  void* const input,
+  const std::uint32_t width,
+  const std::uint32_t height,
+  const DX_BAYER_CONVERT_TYPE conversion_type,
+  const DX_PIXEL_COLOR_FILTER bayer_layout,
+  const bool flip = false)
+{
+  std::unique_ptr<unsigned char[]> result{new unsigned char[width * height * 3]};
+  call(DxRaw8toRGB24, input, result.get(), width, height, conversion_type, bayer_layout, flip);
+  return result;
+}
+
+/**
+ * @overload
+ *
+ * @param output The buffer of at least `width * height * 3` bytes to write
+ * the result to (for example, allocated by Huge_page_arena).
+ */
+inline void raw8_to_rgb24(void* const input,
+  void* const output,
+  const std::uint32_t width,
+  const std::uint32_t height,
+  const DX_BAYER_CONVERT_TYPE conversion_type,
+  const DX_PIXEL_COLOR_FILTER bayer_layout,
+  const bool flip = false)
+{
+  call(DxRaw8toRGB24, input, output, width, height, conversion_type, bayer_layout, flip);
+}
+
+// -----------------------------------------------------------------------------
+// CPU features
+// -----------------------------------------------------------------------------
+
+/// An instruction set level of SIMD kernels.
+enum class Simd_level : unsigned {
+  /// Portable code.
+  scalar = 0,
+  /// SSE4.1.
+  sse41 = 1,
+  /// AVX2.
+  avx2 = 2,
+  /// AVX-512 (F and BW).
+  avx512 = 3
+};
+
+/// @returns The string representation of the `level`.
+constexpr const char* to_literal(const Simd_level level) noexcept
+{
+  switch (level) {
+  case Simd_level::scalar: return "scalar";
+  case Simd_level::sse41: return "sse4.1";
+  case Simd_level::avx2: return "avx2";
+  case Simd_level::avx512: return "avx512";
+  }
+  return "unknown";
+}
+
+/// @returns The highest level supported by the host CPU and OS.
+inline Simd_level host_simd_level() noexcept
+{
+  static const Simd_level result = []() noexcept
+  {
+#if defined(DMITIGR_GENICAM_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+      return Simd_level::avx512;
+    else if (__builtin_cpu_supports("avx2"))
+      return Simd_level::avx2;
+    else if (__builtin_cpu_supports("sse4.1"))
+      return Simd_level::sse41;
+#elif defined(DMITIGR_GENICAM_X86) && defined(_MSC_VER)
+    int r[4]{};
+    __cpuid(r, 1);
+    const bool sse41 = r[2] & (1 << 19);
+    const bool osxsave = r[2] & (1 << 27);
+    const auto xcr0 = osxsave ? _xgetbv(0) : 0;
+    __cpuidex(r, 7, 0);
+    const bool avx2 = (r[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6;
+    const bool avx512 = (r[1] & (1 << 16)) && (r[1] & (1 << 30)) && (xcr0 & 0xe6) == 0xe6;
+    if (avx512 && avx2)
+      return Simd_level::avx512;
+    else if (avx2)
+      return Simd_level::avx2;
+    else if (sse41)
+      return Simd_level::sse41;
+#endif
+    return Simd_level::scalar;
+  }();
+  return result;
+}
+
+/// The kernel which can be dispatched at runtime.
+class Kernel_base {
+public:
+  /// @returns The name of the kernel.
+  const char* name() const noexcept
+  {
+    return name_;
+  }
+
+  /// @returns `true` if the kernel has the implementation for the `level`.
+  virtual bool has_implementation(Simd_level level) const noexcept = 0;
+
+  /// @returns The level of the implementation which is selected.
+  virtual Simd_level selected_level() const noexcept = 0;
+
+protected:
+  friend void set_simd_level_override(std::optional<Simd_level>);
+
+  /// Registers the kernel.
+  explicit Kernel_base(const char* const name)
+    : name_{name}
+  {
+    const std::lock_guard lg{registry_mutex()};
+    registry().push_back(this);
+  }
+
+  /// Unregisters the kernel.
+  ~Kernel_base()
+  {
+    const std::lock_guard lg{registry_mutex()};
+    auto& r = registry();
+    r.erase(std::remove(r.begin(), r.end(), this), r.end());
+  }
+
+  Kernel_base(const Kernel_base&) = delete;
+  Kernel_base& operator=(const Kernel_base&) = delete;
+  Kernel_base(Kernel_base&&) = delete;
+  Kernel_base& operator=(Kernel_base&&) = delete;
+
+  /// Resets the selected implementation, so it's selected again on next use.
+  virtual void reset() const noexcept = 0;
+
+  static std::mutex& registry_mutex() noexcept
+  {
+    static std::mutex result;
+    return result;
+  }
+
+  static std::vector<const Kernel_base*>& registry() noexcept
+  {
+    static std::vector<const Kernel_base*> result;
+    return result;
+  }
+
+  static std::atomic<int>& simd_level_override() noexcept
+  {
+    static std::atomic<int> result{[]
+    {
+      // The override can be also set by the environment variable.
+      if (const char* const env = std::getenv("DMITIGR_GENICAM_SIMD_LEVEL")) {
+        const std::string value{env};
+        for (unsigned i{}; i <= static_cast<unsigned>(Simd_level::avx512); ++i) {
+          if (value == to_literal(static_cast<Simd_level>(i)))
+            return static_cast<int>(i);
+        }
+      }
+      return -1;
+    }()};
+    return result;
+  }
+
+  friend Simd_level simd_level() noexcept;
+  friend std::vector<const Kernel_base*> kernels();
+
+private:
+  const char* name_{};
+};
+
+/**
+ * @returns The level to be used by kernels, which is the minimum of the
+ * host_simd_level() and the override if it's set.
+ *
+ * @see set_simd_level_override().
+ */
+inline Simd_level simd_level() noexcept
+{
+  const auto level = host_simd_level();
+  const auto over = Kernel_base::simd_level_override().load(std::memory_order_relaxed);
+  return over < 0 ? level :
+    std::min(level, static_cast<Simd_level>(static_cast<unsigned>(over)));
+}
+
+/**
+ * Forces the kernels to use the implementations of the `level` at most (for
+ * example, for benchmarking). The kernels select their implementations
+ * again on next use.
+ *
+ * @param level The level, or `std::nullopt` to reset the override.
+ *
+ * @remarks The initial override can be set by the environment variable
+ * `DMITIGR_GENICAM_SIMD_LEVEL` (to `scalar`, `sse4.1`, `avx2` or `avx512`).
+ */
+inline void set_simd_level_override(const std::optional<Simd_level> level)
+{
+  Kernel_base::simd_level_override().store(level ? static_cast<int>(*level) : -1);
+  const std::lock_guard lg{Kernel_base::registry_mutex()};
+  for (const auto* const kernel : Kernel_base::registry())
+    kernel->reset();
+}
+
+/// @returns The registered kernels.
+inline std::vector<const Kernel_base*> kernels()
+{
+  const std::lock_guard lg{Kernel_base::registry_mutex()};
+  return Kernel_base::registry();
+}
+
+template<typename> class Kernel;
+
+/**
+ * A kernel with several implementations (one per Simd_level). The best
+ * implementation for the host is selected once, at first use.
+ */
+template<typename R, typename ... Args>
+class Kernel<R(Args...)> final : public Kernel_base {
+public:
+  /// The implementation.
+  using Function = R(*)(Args...);
+
+  /**
+   * The constructor.
+   *
+   * @par Requires
+   * `scalar`.
+   */
+  Kernel(const char* const name, const Function scalar,
+    const Function sse41 = {}, const Function avx2 = {}, const Function avx512 = {})
+    : Kernel_base{name}
+    , impls_{scalar, sse41, avx2, avx512}
+  {
+    if (!scalar)
+      throw std::invalid_argument{"invalid scalar kernel"};
+  }
+
+  /// Calls the selected implementation.
+  R operator()(Args ... args) const
+  {
+    return selected()(args...);
+  }
+
+  /// @returns The selected implementation.
+  Function selected() const noexcept
+  {
+    if (const auto result = selected_.load(std::memory_order_acquire))
+      return result;
+
+    const auto result = impls_[static_cast<unsigned>(select())];
+    selected_.store(result, std::memory_order_release);
+    return result;
+  }
+
+  /**
+   * @returns The implementation of the `level`, or `nullptr` if there is no
+   * such implementation or the host doesn't support it.
+   */
+  Function implementation(const Simd_level level) const noexcept
+  {
+    return level <= host_simd_level() ? impls_[static_cast<unsigned>(level)] : nullptr;
+  }
+
+  bool has_implementation(const Simd_level level) const noexcept override
+  {
+    return impls_[static_cast<unsigned>(level)];
+  }
+
+  Simd_level selected_level() const noexcept override
+  {
+    return select();
+  }
+
+private:
+  std::array<Function, 4> impls_{};
+  mutable std::atomic<Function> selected_{};
+
+  Simd_level select() const noexcept
+  {
+    auto level = static_cast<unsigned>(simd_level());
+    while (level && !impls_[level])
+      level--;
+    return static_cast<Simd_level>(level);
+  }
+
+  void reset() const noexcept override
+  {
+    selected_.store(nullptr, std::memory_order_release);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Row statistics kernels
+// -----------------------------------------------------------------------------
+
+/// The statistics of a row of samples.
+struct Row_statistics final {
+  std::uint32_t min{UINT32_MAX};
+  std::uint32_t max{};
+  std::uint64_t sum{};
+};
+
+template<typename T>
+inline void row_statistics_scalar(const T* const data, const std::size_t size,
+  Row_statistics& stats) noexcept
+{
+  std::uint32_t mn{stats.min}, mx{stats.max};
+  std::uint64_t sum{};
+  for (std::size_t i{}; i < size; ++i) {
+    const std::uint32_t v = data[i];
+    mn = std::min(mn, v);
+    mx = std::max(mx, v);
+    sum += v;
+  }
+  stats.min = mn;
+  stats.max = mx;
+  stats.sum += sum;
+}
+
+#ifdef DMITIGR_GENICAM_X86
+
+/// Reduces the vectors of min, max (8-bit lanes) and sum (64-bit lanes).
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void reduce_u8(__m128i mn, __m128i mx, const __m128i sum,
+  Row_statistics& stats) noexcept
+{
+  mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 8));
+  mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4));
+  mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 2));
+  mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 1));
+  mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 8));
+  mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+  mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 2));
+  mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 1));
+  alignas(16) std::uint64_t s[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(s), sum);
+  stats.min = std::min(stats.min, static_cast<std::uint32_t>(_mm_cvtsi128_si32(mn) & 0xff));
+  stats.max = std::max(stats.max, static_cast<std::uint32_t>(_mm_cvtsi128_si32(mx) & 0xff));
+  stats.sum += s[0] + s[1];
+}
+
+/// Reduces the vectors of min, max (16-bit lanes) and sum (64-bit lanes).
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void reduce_u16(__m128i mn, __m128i mx, const __m128i sum,
+  Row_statistics& stats) noexcept
+{
+  mn = _mm_min_epu16(mn, _mm_srli_si128(mn, 8));
+  mn = _mm_min_epu16(mn, _mm_srli_si128(mn, 4));
+  mn = _mm_min_epu16(mn, _mm_srli_si128(mn, 2));
+  mx = _mm_max_epu16(mx, _mm_srli_si128(mx, 8));
+  mx = _mm_max_epu16(mx, _mm_srli_si128(mx, 4));
+  mx = _mm_max_epu16(mx, _mm_srli_si128(mx, 2));
+  alignas(16) std::uint64_t s[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(s), sum);
+  stats.min = std::min(stats.min, static_cast<std::uint32_t>(_mm_cvtsi128_si32(mn) & 0xffff));
+  stats.max = std::max(stats.max, static_cast<std::uint32_t>(_mm_cvtsi128_si32(mx) & 0xffff));
+  stats.sum += s[0] + s[1];
+}
+
+/// @returns The sum of 16-bit lanes of `v` widened to 64-bit lanes.
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline __m128i sum_u16(const __m128i v) noexcept
+{
+  const auto zero = _mm_setzero_si128();
+  const auto s32 = _mm_add_epi32(_mm_unpacklo_epi16(v, zero), _mm_unpackhi_epi16(v, zero));
+  return _mm_add_epi64(_mm_unpacklo_epi32(s32, zero), _mm_unpackhi_epi32(s32, zero));
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void row_statistics_u8_sse41(const std::uint8_t* const data,
+  const std::size_t size, Row_statistics& stats) noexcept
+{
+  const auto zero = _mm_setzero_si128();
+  auto mn = _mm_set1_epi8(-1), mx = zero, sum = zero;
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    mn = _mm_min_epu8(mn, v);
+    mx = _mm_max_epu8(mx, v);
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+  }
+  if (i)
+    reduce_u8(mn, mx, sum, stats);
+  row_statistics_scalar(data + i, size - i, stats);
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void row_statistics_u16_sse41(const std::uint16_t* const data,
+  const std::size_t size, Row_statistics& stats) noexcept
+{
+  auto mn = _mm_set1_epi16(-1), mx = _mm_setzero_si128(), sum = mx;
+  std::size_t i{};
+  for (; i + 8 <= size; i += 8) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    mn = _mm_min_epu16(mn, v);
+    mx = _mm_max_epu16(mx, v);
+    sum = _mm_add_epi64(sum, sum_u16(v));
+  }
+  if (i)
+    reduce_u16(mn, mx, sum, stats);
+  row_statistics_scalar(data + i, size - i, stats);
+}
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void row_statistics_u8_avx2(const std::uint8_t* const data,
+  const std::size_t size, Row_statistics& stats) noexcept
+{
+  const auto zero = _mm256_setzero_si256();
+  auto mn = _mm256_set1_epi8(-1), mx = zero, sum = zero;
+  std::size_t i{};
+  for (; i + 32 <= size; i += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    mn = _mm256_min_epu8(mn, v);
+    mx = _mm256_max_epu8(mx, v);
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(v, zero));
+  }
+  if (i)
+    reduce_u8(
+      _mm_min_epu8(_mm256_castsi256_si128(mn), _mm256_extracti128_si256(mn, 1)),
+      _mm_max_epu8(_mm256_castsi256_si128(mx), _mm256_extracti128_si256(mx, 1)),
+      _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)),
+      stats);
+  row_statistics_scalar(data + i, size - i, stats);
+}
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void row_statistics_u16_avx2(const std::uint16_t* const data,
+  const std::size_t size, Row_statistics& stats) noexcept
+{
+  const auto zero = _mm256_setzero_si256();
+  auto mn = _mm256_set1_epi16(-1), mx = zero, sum = zero;
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    mn = _mm256_min_epu16(mn, v);
+    mx = _mm256_max_epu16(mx, v);
+    const auto s32 = _mm256_add_epi32(_mm256_unpacklo_epi16(v, zero),
+      _mm256_unpackhi_epi16(v, zero));
+    sum = _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_unpacklo_epi32(s32, zero),
+        _mm256_unpackhi_epi32(s32, zero)));
+  }
+  if (i)
+    reduce_u16(
+      _mm_min_epu16(_mm256_castsi256_si128(mn), _mm256_extracti128_si256(mn, 1)),
+      _mm_max_epu16(_mm256_castsi256_si128(mx), _mm256_extracti128_si256(mx, 1)),
+      _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)),
+      stats);
+  row_statistics_scalar(data + i, size - i, stats);
+}
+
+DMITIGR_GENICAM_TARGET("avx512f,avx512bw")
+inline void row_statistics_u8_avx512(const std::uint8_t* const data,
+  const std::size_t size, Row_statistics& stats) noexcept
+{
+  const auto zero = _mm512_setzero_si512();
+  auto mn = _mm512_set1_epi8(-1), mx = zero, sum = zero;
+  std::size_t i{};
+  for (; i + 64 <= size; i += 64) {
+    const auto v = _mm512_loadu_si512(data + i);
+    mn = _mm512_min_epu8(mn, v);
+    mx = _mm512_max_epu8(mx, v);
+    sum = _mm512_add_epi64(sum, _mm512_sad_epu8(v, zero));
+  }
+  if (i) {
+    // Spill the lanes instead of extracting them to reduce in 128 bits.
+    alignas(64) __m128i v[3][4];
+    _mm512_store_si512(v[0], mn);
+    _mm512_store_si512(v[1], mx);
+    _mm512_store_si512(v[2], sum);
+    reduce_u8(
+      _mm_min_epu8(_mm_min_epu8(v[0][0], v[0][1]), _mm_min_epu8(v[0][2], v[0][3])),
+      _mm_max_epu8(_mm_max_epu8(v[1][0], v[1][1]), _mm_max_epu8(v[1][2], v[1][3])),
+      _mm_add_epi64(_mm_add_epi64(v[2][0], v[2][1]), _mm_add_epi64(v[2][2], v[2][3])),
+      stats);
+  }
+  row_statistics_scalar(data + i, size - i, stats);
+}
+
+#define DMITIGR_GENICAM_ROW_STATISTICS_U8 \
+  row_statistics_u8_sse41, row_statistics_u8_avx2, row_statistics_u8_avx512
+#define DMITIGR_GENICAM_ROW_STATISTICS_U16 \
+  row_statistics_u16_sse41, row_statistics_u16_avx2
+#else
+#define DMITIGR_GENICAM_ROW_STATISTICS_U8 nullptr
+#define DMITIGR_GENICAM_ROW_STATISTICS_U16 nullptr
+#endif
+
+/// Accumulates the statistics of the row of 8-bit samples.
+inline const Kernel<void(const std::uint8_t*, std::size_t, Row_statistics&)>
+row_statistics_u8{"row_statistics_u8", row_statistics_scalar<std::uint8_t>,
+  DMITIGR_GENICAM_ROW_STATISTICS_U8};
+
+/// Accumulates the statistics of the row of 16-bit samples.
+inline const Kernel<void(const std::uint16_t*, std::size_t, Row_statistics&)>
+row_statistics_u16{"row_statistics_u16", row_statistics_scalar<std::uint16_t>,
+  DMITIGR_GENICAM_ROW_STATISTICS_U16};
+
+#undef DMITIGR_GENICAM_ROW_STATISTICS_U8
+#undef DMITIGR_GENICAM_ROW_STATISTICS_U16
+
+// -----------------------------------------------------------------------------
+// Pixel formats
+// -----------------------------------------------------------------------------
+
+/// A color of the color filter array.
+enum class Cfa_color : unsigned { red = 0, green = 1, blue = 2 };
+
+/**
+ * @returns The color of the pixel at the given parities of row and column
+ * of the color filter array of the given `layout`.
+ *
+ * @par Requires
+ * `layout != NONE`.
+ */
+constexpr Cfa_color cfa_color(const DX_PIXEL_COLOR_FILTER layout,
+  const unsigned row, const unsigned column) noexcept
+{
+  // Position of the red pixel in the 2x2 cell: (row, column).
+  unsigned r_row{}, r_col{};
+  switch (layout) {
+  case BAYERRG: r_row = 0; r_col = 0; break;
+  case BAYERGR: r_row = 0; r_col = 1; break;
+  case BAYERGB: r_row = 1; r_col = 0; break;
+  case BAYERBG: r_row = 1; r_col = 1; break;
+  default: break;
+  }
+  const unsigned y{row & 1}, x{column & 1};
+  if (y == r_row && x == r_col)
+    return Cfa_color::red;
+  else if (y != r_row && x != r_col)
+    return Cfa_color::blue;
+  else
+    return Cfa_color::green;
+}
+
+/// The description of a pixel format.
+struct Pixel_format_info final {
+  /// The number of bits occupied by a pixel (for packed formats - on average).
+  unsigned bits_per_pixel{};
+  /// The number of significant bits of a channel.
+  unsigned significant_bits{};
+  /// The number of channels.
+  unsigned channel_count{};
+  /// `true` if the pixels are packed (not aligned to bytes).
+  bool is_packed{};
+  /// The layout of the color filter array, or `NONE` if not Bayer.
+  DX_PIXEL_COLOR_FILTER bayer_layout{NONE};
+  /// `true` if the channels are ordered as BGR.
+  bool is_bgr{};
+  /// `true` if the format is known.
+  bool is_known{};
+
+  /// @returns `true` if the format is Bayer.
+  constexpr bool is_bayer() const noexcept
+  {
+    return bayer_layout != NONE;
+  }
+
+  /// @returns `true` if the format is monochrome (not Bayer).
+  constexpr bool is_mono() const noexcept
+  {
+    return is_known && channel_count == 1 && !is_bayer();
+  }
+
+  /// @returns `true` if the format has several color channels per pixel.
+  constexpr bool is_color() const noexcept
+  {
+    return channel_count > 1;
+  }
+
+  /**
+   * @returns The number of bytes of a channel of unpacked formats, or `0`
+   * for packed formats.
+   */
+  constexpr unsigned bytes_per_channel() const noexcept
+  {
+    return is_packed || !channel_count ? 0 : bits_per_pixel / channel_count / 8;
+  }
+};
+
+/// @returns The description of the pixel `format`.
+constexpr Pixel_format_info pixel_format_info(const GX_PIXEL_FORMAT_ENTRY format) noexcept
+{
+  // The bits 16-23 of the format denote the number of occupied bits.
+  const unsigned bpp = (static_cast<std::uint32_t>(format) >> 16) & 0xff;
+  const auto info = [bpp](const unsigned significant_bits,
+    const unsigned channel_count, const DX_PIXEL_COLOR_FILTER bayer_layout = NONE,
+    const bool is_packed = false, const bool is_bgr = false)
+  {
+    return Pixel_format_info{bpp, significant_bits, channel_count, is_packed,
+      bayer_layout, is_bgr, true};
+  };
+  switch (format) {
+  case GX_PIXEL_FORMAT_MONO8: return info(8, 1);
+  case GX_PIXEL_FORMAT_MONO10: return info(10, 1);
+  case GX_PIXEL_FORMAT_MONO12: return info(12, 1);
+  case GX_PIXEL_FORMAT_MONO16: return info(16, 1);
+  case GX_PIXEL_FORMAT_MONO10_PACKED: return info(10, 1, NONE, true);
+  case GX_PIXEL_FORMAT_MONO12_PACKED: return info(12, 1, NONE, true);
+  case GX_PIXEL_FORMAT_BAYER_GR8: return info(8, 1, BAYERGR);
+  case GX_PIXEL_FORMAT_BAYER_RG8: return info(8, 1, BAYERRG);
+  case GX_PIXEL_FORMAT_BAYER_GB8: return info(8, 1, BAYERGB);
+  case GX_PIXEL_FORMAT_BAYER_BG8: return info(8, 1, BAYERBG);
+  case GX_PIXEL_FORMAT_BAYER_GR10: return info(10, 1, BAYERGR);
+  case GX_PIXEL_FORMAT_BAYER_RG10: return info(10, 1, BAYERRG);
+  case GX_PIXEL_FORMAT_BAYER_GB10: return info(10, 1, BAYERGB);
+  case GX_PIXEL_FORMAT_BAYER_BG10: return info(10, 1, BAYERBG);
+  case GX_PIXEL_FORMAT_BAYER_GR12: return info(12, 1, BAYERGR);
+  case GX_PIXEL_FORMAT_BAYER_RG12: return info(12, 1, BAYERRG);
+  case GX_PIXEL_FORMAT_BAYER_GB12: return info(12, 1, BAYERGB);
+  case GX_PIXEL_FORMAT_BAYER_BG12: return info(12, 1, BAYERBG);
+  case GX_PIXEL_FORMAT_BAYER_GR16: return info(16, 1, BAYERGR);
+  case GX_PIXEL_FORMAT_BAYER_RG16: return info(16, 1, BAYERRG);
+  case GX_PIXEL_FORMAT_BAYER_GB16: return info(16, 1, BAYERGB);
+  case GX_PIXEL_FORMAT_BAYER_BG16: return info(16, 1, BAYERBG);
+  case GX_PIXEL_FORMAT_RGB8: return info(8, 3);
+  case GX_PIXEL_FORMAT_BGR8: return info(8, 3, NONE, false, true);
+  default: return Pixel_format_info{};
+  }
+}
+
+/// The compile-time traits of the pixel format `F`.
+template<GX_PIXEL_FORMAT_ENTRY F>
+struct Pixel_format_traits final {
+  static_assert(pixel_format_info(F).is_known, "unknown pixel format");
+
+  /// The pixel format.
+  static constexpr GX_PIXEL_FORMAT_ENTRY format{F};
+
+  /// The description of the pixel format.
+  static constexpr Pixel_format_info info{pixel_format_info(F)};
+
+  /// The type of a channel value (for unpacked formats).
+  using Channel_type = std::conditional_t<info.significant_bits <= 8,
+    std::uint8_t, std::uint16_t>;
+
+  /// The maximum value of a channel.
+  static constexpr std::uint32_t max_value{(1u << info.significant_bits) - 1};
+};
+
+/// The pixel format as the type.
+template<GX_PIXEL_FORMAT_ENTRY F>
+using Pixel_format_constant = std::integral_constant<GX_PIXEL_FORMAT_ENTRY, F>;
+
+/**
+ * Calls `f(Pixel_format_constant<F>{})` where `F` is the value of `format`,
+ * so `f` can be a generic lambda which instantiates a kernel specialized for
+ * the pixel format, without any per-pixel branching.
+ *
+ * @returns The value returned by `f`. (The return type of `f` must be the
+ * same for all the pixel formats.)
+ *
+ * @throws `std::runtime_error` if the `format` is packed or unknown.
+ */
+template<typename F>
+decltype(auto) dispatch_pixel_format(const GX_PIXEL_FORMAT_ENTRY format, F&& f)
+{
+#define DMITIGR_GENICAM_DISPATCH(fmt) \
+  case fmt: return f(Pixel_format_constant<fmt>{})
+  switch (format) {
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_MONO8);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_MONO10);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_MONO12);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_MONO16);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GR8);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_RG8);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GB8);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_BG8);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GR10);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_RG10);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GB10);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_BG10);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GR12);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_RG12);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GB12);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_BG12);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GR16);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_RG16);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_GB16);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BAYER_BG16);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_RGB8);
+  DMITIGR_GENICAM_DISPATCH(GX_PIXEL_FORMAT_BGR8);
+  default:
+    throw std::runtime_error{"the format is not supported"};
+  }
+#undef DMITIGR_GENICAM_DISPATCH
+}
+
+/**
+ * @returns The Bayer format of the `bayer_layout` and the number of
+ * `significant_bits` (`8`, `10`, `12` or `16`), or `GX_PIXEL_FORMAT_UNDEFINED`
+ * if there is no such a format.
+ */
+constexpr GX_PIXEL_FORMAT_ENTRY bayer_pixel_format(
+  const DX_PIXEL_COLOR_FILTER bayer_layout, const unsigned significant_bits) noexcept
+{
+  constexpr GX_PIXEL_FORMAT_ENTRY formats[4][4]{
+    {GX_PIXEL_FORMAT_BAYER_RG8, GX_PIXEL_FORMAT_BAYER_RG10,
+     GX_PIXEL_FORMAT_BAYER_RG12, GX_PIXEL_FORMAT_BAYER_RG16},
+    {GX_PIXEL_FORMAT_BAYER_GB8, GX_PIXEL_FORMAT_BAYER_GB10,
+     GX_PIXEL_FORMAT_BAYER_GB12, GX_PIXEL_FORMAT_BAYER_GB16},
+    {GX_PIXEL_FORMAT_BAYER_GR8, GX_PIXEL_FORMAT_BAYER_GR10,
+     GX_PIXEL_FORMAT_BAYER_GR12, GX_PIXEL_FORMAT_BAYER_GR16},
+    {GX_PIXEL_FORMAT_BAYER_BG8, GX_PIXEL_FORMAT_BAYER_BG10,
+     GX_PIXEL_FORMAT_BAYER_BG12, GX_PIXEL_FORMAT_BAYER_BG16}};
+  int row{-1}, col{-1};
+  switch (bayer_layout) {
+  case BAYERRG: row = 0; break;
+  case BAYERGB: row = 1; break;
+  case BAYERGR: row = 2; break;
+  case BAYERBG: row = 3; break;
+  default: break;
+  }
+  switch (significant_bits) {
+  case 8: col = 0; break;
+  case 10: col = 1; break;
+  case 12: col = 2; break;
+  case 16: col = 3; break;
+  default: break;
+  }
+  return row < 0 || col < 0 ? GX_PIXEL_FORMAT_UNDEFINED : formats[row][col];
+}
+
+// -----------------------------------------------------------------------------
+// Statistics
+// -----------------------------------------------------------------------------
+
+/// The statistics of a channel.
+struct Channel_statistics final {
+  std::uint32_t min{};
+  std::uint32_t max{};
+  double mean{};
+};
+
+/**
+ * The statistics of an image. Channels are ordered as RGB for both color and
+ * Bayer formats.
+ */
+struct Statistics final {
+  unsigned channel_count{};
+  std::array<Channel_statistics, 3> channels{};
+};
+
+/**
+ * @returns The statistics of the image of the pixel format `F`.
+ *
+ * @param data The image.
+ * @param stride The number of bytes between rows. `0` means tightly packed.
+ */
+template<GX_PIXEL_FORMAT_ENTRY F>
+Statistics statistics(const void* const data, const std::uint32_t width,
+  const std::uint32_t height, std::size_t stride = 0)
+{
+  using Traits = Pixel_format_traits<F>;
+  using T = typename Traits::Channel_type;
+  constexpr auto info = Traits::info;
+  constexpr unsigned cc{info.channel_count};
+  constexpr unsigned stat_count{info.is_bayer() ? 3 : cc};
+  static_assert(!info.is_packed);
+  if (!stride)
+    stride = std::size_t{width} * cc * sizeof(T);
+
+  std::array<std::uint32_t, stat_count> min;
+  std::array<std::uint32_t, stat_count> max{};
+  std::array<std::uint64_t, stat_count> sum{};
+  std::array<std::uint64_t, stat_count> count{};
+  min.fill(Traits::max_value);
+  const auto* const base = static_cast<const unsigned char*>(data);
+
+  const auto accumulate = [&](const T* const row, const std::size_t n,
+    const std::size_t step, const unsigned c)
+  {
+    std::uint32_t mn{min[c]}, mx{max[c]};
+    std::uint64_t sm{};
+    for (std::size_t i{}; i < n; ++i) {
+      const std::uint32_t v = row[i * step];
+      mn = std::min(mn, v);
+      mx = std::max(mx, v);
+      sm += v;
+    }
+    min[c] = mn;
+    max[c] = mx;
+    sum[c] += sm;
+    count[c] += n;
+  };
+
+  for (std::uint32_t y{}; y < height; ++y) {
+    const auto* const row = reinterpret_cast<const T*>(base + y * stride);
+    if constexpr (info.is_bayer()) {
+      constexpr auto c00 = static_cast<unsigned>(cfa_color(info.bayer_layout, 0, 0));
+      constexpr auto c01 = static_cast<unsigned>(cfa_color(info.bayer_layout, 0, 1));
+      constexpr auto c10 = static_cast<unsigned>(cfa_color(info.bayer_layout, 1, 0));
+      constexpr auto c11 = static_cast<unsigned>(cfa_color(info.bayer_layout, 1, 1));
+      const bool odd = y & 1;
+      accumulate(row, (width + 1) / 2, 2, odd ? c10 : c00);
+      accumulate(row + 1, width / 2, 2, odd ? c11 : c01);
+    } else if constexpr (cc == 1) {
+      Row_statistics rs{min[0], max[0], 0};
+      if constexpr (sizeof(T) == 1)
+        row_statistics_u8(row, width, rs);
+      else
+        row_statistics_u16(row, width, rs);
+      min[0] = rs.min;
+      max[0] = rs.max;
+      sum[0] += rs.sum;
+      count[0] += width;
+    } else {
+      for (unsigned c{}; c < cc; ++c)
+        accumulate(row + c, width, cc, info.is_bgr ? cc - 1 - c : c);
+    }
+  }
+
+  Statistics result;
+  result.channel_count = stat_count;
+  for (unsigned c{}; c < stat_count; ++c) {
+    if (count[c]) {
+      result.channels[c].min = min[c];
+      result.channels[c].max = max[c];
+      result.channels[c].mean = static_cast<double>(sum[c]) / static_cast<double>(count[c]);
+    }
+  }
+  return result;
+}
+
+/**
+ * @overload
+ *
+ * @details Dispatches the `format` to the specialized kernel.
+ */
+inline Statistics statistics(const void* const data, const std::uint32_t width,
+  const std::uint32_t height, const GX_PIXEL_FORMAT_ENTRY format,
+  const std::size_t stride = 0)
+{
+  return dispatch_pixel_format(format, [&](auto fmt)
+  {
+    return statistics<decltype(fmt)::value>(data, width, height, stride);
+  });
+}
+
+// -----------------------------------------------------------------------------
+// Geometric transforms
+// -----------------------------------------------------------------------------
+
+/// A geometric transform of an image.
+enum class Transform : unsigned {
+  /// No transform.
+  none = 0,
+  /// Mirroring of columns.
+  flip_horizontal = 1,
+  /// Mirroring of rows.
+  flip_vertical = 2,
+  /// Rotation by 90 degrees clockwise.
+  rotate_90 = 3,
+  /// Rotation by 180 degrees.
+  rotate_180 = 4,
+  /// Rotation by 270 degrees clockwise.
+  rotate_270 = 5,
+  /// Swapping of rows and columns.
+  transpose = 6
+};
+
+/// @returns The string representation of the `transform`.
+constexpr const char* to_literal(const Transform transform) noexcept
+{
+  switch (transform) {
+  case Transform::none: return "none";
+  case Transform::flip_horizontal: return "flip_horizontal";
+  case Transform::flip_vertical: return "flip_vertical";
+  case Transform::rotate_90: return "rotate_90";
+  case Transform::rotate_180: return "rotate_180";
+  case Transform::rotate_270: return "rotate_270";
+  case Transform::transpose: return "transpose";
+  }
+  return "unknown";
+}
+
+/// @returns `true` if the `transform` swaps the width and the height.
+constexpr bool is_transposing(const Transform transform) noexcept
+{
+  return transform == Transform::rotate_90 || transform == Transform::rotate_270 ||
+    transform == Transform::transpose;
+}
+
+/**
+ * @returns The layout of the color filter array of the Bayer image of the
+ * given size and `layout` after the `transform`. (Since the samples are
+ * moved as is, the colors are preserved, but the pattern may be shifted.)
+ */
+constexpr DX_PIXEL_COLOR_FILTER transformed_bayer_layout(
+  const DX_PIXEL_COLOR_FILTER layout, const Transform transform,
+  const std::uint32_t width, const std::uint32_t height) noexcept
+{
+  if (layout == NONE)
+    return NONE;
+
+  // The color of the output pixel is the color of the input one.
+  const auto color = [&](const std::uint32_t row, const std::uint32_t column)
+  {
+    std::uint32_t x{column}, y{row};
+    switch (transform) {
+    case Transform::none: break;
+    case Transform::flip_horizontal: x = width - 1 - column; break;
+    case Transform::flip_vertical: y = height - 1 - row; break;
+    case Transform::rotate_90: x = row; y = height - 1 - column; break;
+    case Transform::rotate_180: x = width - 1 - column; y = height - 1 - row; break;
+    case Transform::rotate_270: x = width - 1 - row; y = column; break;
+    case Transform::transpose: x = row; y = column; break;
+    }
+    return cfa_color(layout, y, x);
+  };
+  if (color(0, 0) == Cfa_color::red)
+    return BAYERRG;
+  else if (color(0, 1) == Cfa_color::red)
+    return BAYERGR;
+  else if (color(1, 0) == Cfa_color::red)
+    return BAYERGB;
+  else
+    return BAYERBG;
+}
+
+/// The arguments of the transform kernel.
+struct Transform_args final {
+  /// The row `row_begin` of the input image.
+  const std::uint8_t* input{};
+  /// The number of bytes between rows of the `input`.
+  std::size_t input_stride{};
+  /// The output image.
+  std::uint8_t* output{};
+  /// The number of bytes between rows of the `output`.
+  std::size_t output_stride{};
+  /// The width of the input image.
+  std::uint32_t width{};
+  /// The height of the input image.
+  std::uint32_t height{};
+  /// The first row of the input to transform.
+  std::uint32_t row_begin{};
+  /// The row past the last one of the input to transform.
+  std::uint32_t row_end{};
+  /// The number of bytes of a pixel (`1`, `2`, `3` or `4`).
+  unsigned element_size{1};
+  /// The transform.
+  Transform transform{Transform::none};
+};
+
+/**
+ * The mapping of the input pixels to the output: the pixel `(x, y)` goes
+ * to `base + x * x_step + y * y_step`.
+ */
+struct Transform_mapping final {
+  std::uint8_t* base{};
+  std::ptrdiff_t x_step{};
+  std::ptrdiff_t y_step{};
+};
+
+/// @returns The mapping of the transform.
+inline Transform_mapping transform_mapping(const Transform_args& a) noexcept
+{
+  const auto e = static_cast<std::ptrdiff_t>(a.element_size);
+  const auto s = static_cast<std::ptrdiff_t>(a.output_stride);
+  const auto w1 = static_cast<std::ptrdiff_t>(a.width) - 1;
+  const auto h1 = static_cast<std::ptrdiff_t>(a.height) - 1;
+  auto* const o = a.output;
+  switch (a.transform) {
+  case Transform::none: return {o, e, s};
+  case Transform::flip_horizontal: return {o + w1 * e, -e, s};
+  case Transform::flip_vertical: return {o + h1 * s, e, -s};
+  case Transform::rotate_90: return {o + h1 * e, s, -e};
+  case Transform::rotate_180: return {o + h1 * s + w1 * e, -e, -s};
+  case Transform::rotate_270: return {o + w1 * s, -s, e};
+  case Transform::transpose: return {o, s, e};
+  }
+  return {o, e, s};
+}
+
+/// Transforms the pixels in range `[x_begin, x_end)` of the rows `[y_begin, y_end)`.
+template<unsigned E>
+inline void transform_pixels_scalar(const Transform_args& a,
+  const Transform_mapping& m, const std::uint32_t x_begin,
+  const std::uint32_t x_end, const std::uint32_t y_begin,
+  const std::uint32_t y_end) noexcept
+{
+  for (auto y = y_begin; y < y_end; ++y) {
+    const auto* const src = a.input + (y - a.row_begin) * a.input_stride;
+    auto* const dst = m.base + static_cast<std::ptrdiff_t>(y) * m.y_step;
+    for (auto x = x_begin; x < x_end; ++x)
+      std::memcpy(dst + static_cast<std::ptrdiff_t>(x) * m.x_step, src + E * x, E);
+  }
+}
+
+/// @overload
+inline void transform_pixels_scalar(const Transform_args& a,
+  const Transform_mapping& m, const std::uint32_t x_begin,
+  const std::uint32_t x_end, const std::uint32_t y_begin,
+  const std::uint32_t y_end) noexcept
+{
+  switch (a.element_size) {
+  case 1: transform_pixels_scalar<1>(a, m, x_begin, x_end, y_begin, y_end); return;
+  case 2: transform_pixels_scalar<2>(a, m, x_begin, x_end, y_begin, y_end); return;
+  case 3: transform_pixels_scalar<3>(a, m, x_begin, x_end, y_begin, y_end); return;
+  case 4: transform_pixels_scalar<4>(a, m, x_begin, x_end, y_begin, y_end); return;
+  }
+}
+
+/// The size of the side of the square blocks of transposing transforms.
+constexpr std::uint32_t transform_block_size{64};
+
+inline void transform_scalar(const Transform_args& a) noexcept
+{
+  const auto m = transform_mapping(a);
+  const auto w = a.width;
+  if (!is_transposing(a.transform)) {
+    for (auto y = a.row_begin; y < a.row_end; ++y) {
+      if (m.x_step > 0)
+        std::memcpy(m.base + static_cast<std::ptrdiff_t>(y) * m.y_step,
+          a.input + (y - a.row_begin) * a.input_stride, std::size_t{w} * a.element_size);
+      else
+        transform_pixels_scalar(a, m, 0, w, y, y + 1);
+    }
+  } else {
+    // The blocks are cache-resident on both sides.
+    constexpr auto bs = transform_block_size;
+    for (auto y = a.row_begin; y < a.row_end; y += bs) {
+      for (std::uint32_t x{}; x < w; x += bs)
+        transform_pixels_scalar(a, m, x, std::min(x + bs, w), y,
+          std::min(y + bs, a.row_end));
+    }
+  }
+}
+
+#ifdef DMITIGR_GENICAM_X86
+
+/// The masks of `pshufb` to reverse the order of elements of `E` bytes.
+template<unsigned E>
+struct Reverse_mask final {
+  alignas(16) std::int8_t m[16]{};
+
+  constexpr Reverse_mask() noexcept
+  {
+    constexpr unsigned n{16 / E};
+    for (unsigned b{}; b < 16; ++b)
+      m[b] = static_cast<std::int8_t>((n - 1 - b / E) * E + b % E);
+  }
+};
+
+template<unsigned E>
+inline constexpr Reverse_mask<E> reverse_mask;
+
+/// Transposes the square matrix of the `16 / E` vectors of elements of `E` bytes.
+template<unsigned E>
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void transpose(__m128i* const v) noexcept
+{
+  // Each round rotates the bits of the element index (row, column) by one,
+  // so log2(n) rounds swap the row and the column.
+  constexpr unsigned n{16 / E}, half{n / 2};
+  constexpr unsigned rounds{E == 1 ? 4 : E == 2 ? 3 : 2};
+  __m128i o[n];
+  for (unsigned r{}; r < rounds; ++r) {
+    for (unsigned i{}; i < half; ++i) {
+      if constexpr (E == 1) {
+        o[2 * i] = _mm_unpacklo_epi8(v[i], v[i + half]);
+        o[2 * i + 1] = _mm_unpackhi_epi8(v[i], v[i + half]);
+      } else if constexpr (E == 2) {
+        o[2 * i] = _mm_unpacklo_epi16(v[i], v[i + half]);
+        o[2 * i + 1] = _mm_unpackhi_epi16(v[i], v[i + half]);
+      } else {
+        o[2 * i] = _mm_unpacklo_epi32(v[i], v[i + half]);
+        o[2 * i + 1] = _mm_unpackhi_epi32(v[i], v[i + half]);
+      }
+    }
+    for (unsigned i{}; i < n; ++i)
+      v[i] = o[i];
+  }
+}
+
+template<unsigned E>
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void transform_sse41(const Transform_args& a, const Transform_mapping& m) noexcept
+{
+  constexpr unsigned n{16 / E};
+  const auto rev = _mm_load_si128(reinterpret_cast<const __m128i*>(reverse_mask<E>.m));
+  const auto w = a.width;
+  const auto src_row = [&a](const std::uint32_t y)
+  {
+    return a.input + (y - a.row_begin) * a.input_stride;
+  };
+  const auto dst = [&m](const std::uint32_t x, const std::uint32_t y)
+  {
+    return reinterpret_cast<__m128i*>(m.base + static_cast<std::ptrdiff_t>(x) * m.x_step +
+      static_cast<std::ptrdiff_t>(y) * m.y_step);
+  };
+
+  if (!is_transposing(a.transform)) {
+    for (auto y = a.row_begin; y < a.row_end; ++y) {
+      const auto* const src = src_row(y);
+      if (m.x_step > 0) {
+        std::memcpy(dst(0, y), src, std::size_t{w} * E);
+        continue;
+      }
+      std::uint32_t x{};
+      for (; x + n <= w; x += n) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + E * x));
+        _mm_storeu_si128(dst(x + n - 1, y), _mm_shuffle_epi8(v, rev));
+      }
+      transform_pixels_scalar<E>(a, m, x, w, y, y + 1);
+    }
+    return;
+  }
+
+  constexpr auto bs = transform_block_size;
+  for (auto by = a.row_begin; by < a.row_end; by += bs) {
+    const auto y_end = std::min(by + bs, a.row_end);
+    for (std::uint32_t bx{}; bx < w; bx += bs) {
+      const auto x_end = std::min(bx + bs, w);
+      auto y = by;
+      for (; y + n <= y_end; y += n) {
+        auto x = bx;
+        for (; x + n <= x_end; x += n) {
+          __m128i v[n];
+          for (unsigned i{}; i < n; ++i)
+            v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_row(y + i) + E * x));
+          transpose<E>(v);
+          // The vector k holds the input pixels (x + k, [y, y + n)).
+          for (unsigned k{}; k < n; ++k) {
+            if (m.y_step > 0)
+              _mm_storeu_si128(dst(x + k, y), v[k]);
+            else
+              _mm_storeu_si128(dst(x + k, y + n - 1), _mm_shuffle_epi8(v[k], rev));
+          }
+        }
+        transform_pixels_scalar<E>(a, m, x, x_end, y, y + n);
+      }
+      transform_pixels_scalar<E>(a, m, bx, x_end, y, y_end);
+    }
+  }
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void transform_sse41(const Transform_args& a) noexcept
+{
+  const auto m = transform_mapping(a);
+  switch (a.element_size) {
+  case 1: transform_sse41<1>(a, m); return;
+  case 2: transform_sse41<2>(a, m); return;
+  case 4: transform_sse41<4>(a, m); return;
+  default: transform_scalar(a); // RGB24 doesn't fit the lanes
+  }
+}
+
+#define DMITIGR_GENICAM_TRANSFORM transform_sse41
+#else
+#define DMITIGR_GENICAM_TRANSFORM nullptr
+#endif
+
+/// Transforms the rows of the image.
+inline const Kernel<void(const Transform_args&)> transform_kernel{
+  "transform", transform_scalar, DMITIGR_GENICAM_TRANSFORM};
+
+#undef DMITIGR_GENICAM_TRANSFORM
+
+/**
+ * Transforms the image of pixels of `element_size` bytes.
+ *
+ * @param input The input image.
+ * @param output The buffer of the transformed image which must not overlap
+ * the `input`. The output image is `height` pixels wide and `width` pixels
+ * high if is_transposing(transform).
+ * @param input_stride The number of bytes between rows of the `input`. `0`
+ * means tightly packed.
+ * @param output_stride The number of bytes between rows of the `output`. `0`
+ * means tightly packed.
+ *
+ * @par Requires
+ * `element_size` is `1`, `2`, `3` or `4`.
+ */
+inline void transform(const void* const input, void* const output,
+  const std::uint32_t width, const std::uint32_t height,
+  const unsigned element_size, const Transform transform,
+  const std::size_t input_stride = 0, const std::size_t output_stride = 0)
+{
+  if (!element_size || element_size > 4)
+    throw std::invalid_argument{"invalid size of pixel"};
+  else if (!width || !height)
+    return;
+
+  Transform_args args;
+  args.input = static_cast<const std::uint8_t*>(input);
+  args.input_stride = input_stride ? input_stride : std::size_t{width} * element_size;
+  args.output = static_cast<std::uint8_t*>(output);
+  args.output_stride = output_stride ? output_stride :
+    std::size_t{is_transposing(transform) ? height : width} * element_size;
+  args.width = width;
+  args.height = height;
+  args.row_end = height;
+  args.element_size = element_size;
+  args.transform = transform;
+  transform_kernel(args);
+}
+
+/**
+ * @overload
+ *
+ * @details Bayer images are transformed as is, so the layout of the color
+ * filter array of the output may differ from the one of the input.
+ *
+ * @returns The pixel format of the output image.
+ *
+ * @throws `std::runtime_error` if the `format` is packed or unknown.
+ *
+ * @see transformed_bayer_layout().
+ */
+inline GX_PIXEL_FORMAT_ENTRY transform(const void* const input,
+  const GX_PIXEL_FORMAT_ENTRY format, void* const output,
+  const std::uint32_t width, const std::uint32_t height,
+  const Transform transform, const std::size_t input_stride = 0,
+  const std::size_t output_stride = 0)
+{
+  const auto info = pixel_format_info(format);
+  if (!info.is_known || info.is_packed)
+    throw std::runtime_error{"the format is not supported"};
+
+  img::transform(input, output, width, height, info.bits_per_pixel / 8, transform,
+    input_stride, output_stride);
+  return info.is_bayer() ? bayer_pixel_format(transformed_bayer_layout(
+      info.bayer_layout, transform, width, height), info.significant_bits) : format;
+}
+
+// -----------------------------------------------------------------------------
+// Pixel format conversions
+// -----------------------------------------------------------------------------
+
+/// An output pixel format of conversions.
+enum class Output_format : unsigned {
+  /// 24-bit RGB.
+  rgb8 = 0,
+  /// 24-bit BGR (like `DxRaw8toRGB24()` produces).
+  bgr8 = 1,
+  /// 32-bit RGB with opaque alpha.
+  rgba8 = 2,
+  /// 32-bit BGR with opaque alpha.
+  bgra8 = 3,
+  /// 8-bit monochrome.
+  mono8 = 4,
+  /// 16-bit monochrome with the significant bits aligned to the MSB.
+  mono16 = 5
+};
+
+/// @returns The string representation of the `format`.
+constexpr const char* to_literal(const Output_format format) noexcept
+{
+  switch (format) {
+  case Output_format::rgb8: return "rgb8";
+  case Output_format::bgr8: return "bgr8";
+  case Output_format::rgba8: return "rgba8";
+  case Output_format::bgra8: return "bgra8";
+  case Output_format::mono8: return "mono8";
+  case Output_format::mono16: return "mono16";
+  }
+  return "unknown";
+}
+
+/// @returns The number of bytes of a pixel of the `format`.
+constexpr unsigned bytes_per_pixel(const Output_format format) noexcept
+{
+  switch (format) {
+  case Output_format::rgb8:
+  case Output_format::bgr8: return 3;
+  case Output_format::rgba8:
+  case Output_format::bgra8: return 4;
+  case Output_format::mono8: return 1;
+  case Output_format::mono16: return 2;
+  }
+  return 0;
+}
+
+/// @returns `true` if the `format` is monochrome.
+constexpr bool is_mono(const Output_format format) noexcept
+{
+  return format == Output_format::mono8 || format == Output_format::mono16;
+}
+
+/**
+ * @returns `true` if the image of the `input` format can be converted to the
+ * image of the `output` format by convert().
+ *
+ * @details Unpacked monochrome and Bayer formats can be converted to any
+ * output format.
+ */
+constexpr bool is_conversion_supported(const GX_PIXEL_FORMAT_ENTRY input,
+  [[maybe_unused]] const Output_format output) noexcept
+{
+  const auto info = pixel_format_info(input);
+  if (info.is_packed || info.significant_bits < 8 || info.significant_bits > 16)
+    return false;
+  else
+    return info.is_mono() || info.is_bayer();
+}
+
+/// The arguments of the conversion kernels.
+struct Conversion_args final {
+  /// The input image.
+  const std::uint8_t* input{};
+  /// The number of bytes between rows of the `input`.
+  std::size_t input_stride{};
+  /// The number of bytes of an input sample (`1` or `2`).
+  unsigned input_bytes{1};
+  /// The number of significant bits of an input sample (`[8, 16]`).
+  unsigned significant_bits{8};
+  /// The layout of the color filter array of the input, or `NONE`.
+  DX_PIXEL_COLOR_FILTER bayer_layout{NONE};
+  /// The row `row_begin` of the output image.
+  std::uint8_t* output{};
+  /// The number of bytes between rows of the `output`. (Negative to flip.)
+  std::ptrdiff_t output_stride{};
+  /// The output format.
+  Output_format output_format{Output_format::bgr8};
+  /// The width of the image. (At least 2 for Bayer input.)
+  std::uint32_t width{};
+  /// The height of the image. (At least 2 for Bayer input.)
+  std::uint32_t height{};
+  /// The first row to convert.
+  std::uint32_t row_begin{};
+  /// The row past the last one to convert.
+  std::uint32_t row_end{};
+};
+
+/// The offsets of the channels of a color output pixel.
+struct Channel_layout final {
+  unsigned red{};
+  unsigned blue{};
+  unsigned count{};
+};
+
+/// @returns The layout of the color output `format`.
+constexpr Channel_layout channel_layout(const Output_format format) noexcept
+{
+  const bool is_bgr = format == Output_format::bgr8 || format == Output_format::bgra8;
+  return Channel_layout{is_bgr ? 2u : 0u, is_bgr ? 0u : 2u, bytes_per_pixel(format)};
+}
+
+/// @returns The rounded average of `a` and `b` (like `pavgb`).
+constexpr std::uint8_t avg_u8(const unsigned a, const unsigned b) noexcept
+{
+  return static_cast<std::uint8_t>((a + b + 1) >> 1);
+}
+
+/// @returns The rounded average of `a` and `b` (like `pavgw`).
+constexpr std::uint16_t avg_u16(const unsigned a, const unsigned b) noexcept
+{
+  return static_cast<std::uint16_t>((a + b + 1) >> 1);
+}
+
+/// The row context of demosaicing.
+struct Demosaic_row final {
+  const std::uint8_t* up{};
+  const std::uint8_t* cur{};
+  const std::uint8_t* down{};
+  std::uint8_t* out{};
+  unsigned own_parity{};
+  bool is_red_row{};
+};
+
+/// @returns The context of the row `y` with reflection of the borders.
+inline Demosaic_row demosaic_row(const Conversion_args& a, const std::uint32_t y) noexcept
+{
+  const auto yu = y ? y - 1 : 1;
+  const auto yd = y + 1 < a.height ? y + 1 : a.height - 2;
+  Demosaic_row result;
+  result.up = a.input + yu * a.input_stride;
+  result.cur = a.input + y * a.input_stride;
+  result.down = a.input + yd * a.input_stride;
+  result.out = a.output + static_cast<std::ptrdiff_t>(y - a.row_begin) * a.output_stride;
+  const auto c0 = cfa_color(a.bayer_layout, y, 0);
+  const auto c1 = cfa_color(a.bayer_layout, y, 1);
+  result.is_red_row = c0 == Cfa_color::red || c1 == Cfa_color::red;
+  const auto own = result.is_red_row ? Cfa_color::red : Cfa_color::blue;
+  result.own_parity = c0 == own ? 0 : 1;
+  return result;
+}
+
+/**
+ * Demosaics the pixels in range `[x_begin, x_end)` of the row by bilinear
+ * interpolation with reflection of the borders. The samples are reduced to
+ * 8 bits before interpolation and the averages are nested exactly like in
+ * the SIMD kernels, so all the kernels produce identical results.
+ */
+template<typename T>
+inline void demosaic_pixels_scalar(const Conversion_args& a,
+  const Demosaic_row& r, const std::uint32_t x_begin,
+  const std::uint32_t x_end) noexcept
+{
+  const auto* const up = reinterpret_cast<const T*>(r.up);
+  const auto* const cur = reinterpret_cast<const T*>(r.cur);
+  const auto* const down = reinterpret_cast<const T*>(r.down);
+  const unsigned shift{a.significant_bits - 8};
+  const auto ch = channel_layout(a.output_format);
+  const auto w = a.width;
+  for (std::uint32_t x{x_begin}; x < x_end; ++x) {
+    const auto xl = x ? x - 1 : 1;
+    const auto xr = x + 1 < w ? x + 1 : w - 2;
+    const auto h = avg_u8(cur[xl] >> shift, cur[xr] >> shift);
+    const auto v = avg_u8(up[x] >> shift, down[x] >> shift);
+    std::uint8_t c0, g, c1; // c0 - own color of the row, c1 - the other one
+    if ((x & 1) == r.own_parity) {
+      c0 = static_cast<std::uint8_t>(cur[x] >> shift);
+      g = avg_u8(h, v);
+      c1 = avg_u8(avg_u8(up[xl] >> shift, up[xr] >> shift),
+        avg_u8(down[xl] >> shift, down[xr] >> shift));
+    } else {
+      c0 = h;
+      g = static_cast<std::uint8_t>(cur[x] >> shift);
+      c1 = v;
+    }
+    auto* const px = r.out + ch.count * std::size_t{x};
+    px[ch.red] = r.is_red_row ? c0 : c1;
+    px[1] = g;
+    px[ch.blue] = r.is_red_row ? c1 : c0;
+    if (ch.count == 4)
+      px[3] = 0xff;
+  }
+}
+
+/**
+ * Demosaics the green channel of the pixels in range `[x_begin, x_end)` of
+ * the row to the monochrome output. The `Output_format::mono8` output is
+ * exactly the green channel of demosaic_pixels_scalar(), the
+ * `Output_format::mono16` output is interpolated at the full precision of
+ * the input.
+ */
+template<typename T>
+inline void green_pixels_scalar(const Conversion_args& a,
+  const Demosaic_row& r, const std::uint32_t x_begin,
+  const std::uint32_t x_end) noexcept
+{
+  const auto* const up = reinterpret_cast<const T*>(r.up);
+  const auto* const cur = reinterpret_cast<const T*>(r.cur);
+  const auto* const down = reinterpret_cast<const T*>(r.down);
+  const auto w = a.width;
+  if (a.output_format == Output_format::mono8) {
+    const unsigned shift{a.significant_bits - 8};
+    for (std::uint32_t x{x_begin}; x < x_end; ++x) {
+      const auto xl = x ? x - 1 : 1;
+      const auto xr = x + 1 < w ? x + 1 : w - 2;
+      r.out[x] = (x & 1) == r.own_parity ?
+        avg_u8(avg_u8(cur[xl] >> shift, cur[xr] >> shift),
+          avg_u8(up[x] >> shift, down[x] >> shift)) :
+        static_cast<std::uint8_t>(cur[x] >> shift);
+    }
+  } else {
+    const unsigned align{16 - a.significant_bits};
+    auto* const out = reinterpret_cast<std::uint16_t*>(r.out);
+    for (std::uint32_t x{x_begin}; x < x_end; ++x) {
+      const auto xl = x ? x - 1 : 1;
+      const auto xr = x + 1 < w ? x + 1 : w - 2;
+      const unsigned g = (x & 1) == r.own_parity ?
+        avg_u16(avg_u16(cur[xl], cur[xr]), avg_u16(up[x], down[x])) : cur[x];
+      out[x] = static_cast<std::uint16_t>(g << align);
+    }
+  }
+}
+
+/// @overload
+inline void demosaic_pixels_scalar(const Conversion_args& a,
+  const Demosaic_row& r, const std::uint32_t x_begin,
+  const std::uint32_t x_end) noexcept
+{
+  if (a.input_bytes == 1) {
+    if (is_mono(a.output_format))
+      green_pixels_scalar<std::uint8_t>(a, r, x_begin, x_end);
+    else
+      demosaic_pixels_scalar<std::uint8_t>(a, r, x_begin, x_end);
+  } else {
+    if (is_mono(a.output_format))
+      green_pixels_scalar<std::uint16_t>(a, r, x_begin, x_end);
+    else
+      demosaic_pixels_scalar<std::uint16_t>(a, r, x_begin, x_end);
+  }
+}
+
+inline void demosaic_scalar(const Conversion_args& a) noexcept
+{
+  for (auto y = a.row_begin; y < a.row_end; ++y)
+    demosaic_pixels_scalar(a, demosaic_row(a, y), 0, a.width);
+}
+
+/// Converts the pixels in range `[x_begin, x_end)` of the monochrome row.
+template<typename T>
+inline void mono_pixels_scalar(const Conversion_args& a,
+  const std::uint8_t* const input, std::uint8_t* const out,
+  const std::uint32_t x_begin, const std::uint32_t x_end) noexcept
+{
+  const auto* const in = reinterpret_cast<const T*>(input);
+  const unsigned shift{a.significant_bits - 8};
+  switch (a.output_format) {
+  case Output_format::mono8:
+    for (auto x = x_begin; x < x_end; ++x)
+      out[x] = static_cast<std::uint8_t>(in[x] >> shift);
+    return;
+  case Output_format::mono16: {
+    const unsigned up{16 - a.significant_bits};
+    auto* const out16 = reinterpret_cast<std::uint16_t*>(out);
+    for (auto x = x_begin; x < x_end; ++x)
+      out16[x] = static_cast<std::uint16_t>(in[x] << up);
+    return;
+  }
+  case Output_format::rgb8:
+  case Output_format::bgr8:
+    for (auto x = x_begin; x < x_end; ++x) {
+      auto* const px = out + 3 * std::size_t{x};
+      px[0] = px[1] = px[2] = static_cast<std::uint8_t>(in[x] >> shift);
+    }
+    return;
+  case Output_format::rgba8:
+  case Output_format::bgra8:
+    for (auto x = x_begin; x < x_end; ++x) {
+      auto* const px = out + 4 * std::size_t{x};
+      px[0] = px[1] = px[2] = static_cast<std::uint8_t>(in[x] >> shift);
+      px[3] = 0xff;
+    }
+    return;
+  }
+}
+
+/// @overload
+inline void mono_pixels_scalar(const Conversion_args& a,
+  const std::uint8_t* const input, std::uint8_t* const out,
+  const std::uint32_t x_begin, const std::uint32_t x_end) noexcept
+{
+  if (a.input_bytes == 1)
+    mono_pixels_scalar<std::uint8_t>(a, input, out, x_begin, x_end);
+  else
+    mono_pixels_scalar<std::uint16_t>(a, input, out, x_begin, x_end);
+}
+
+inline void mono_scalar(const Conversion_args& a) noexcept
+{
+  for (auto y = a.row_begin; y < a.row_end; ++y)
+    mono_pixels_scalar(a, a.input + y * a.input_stride,
+      a.output + static_cast<std::ptrdiff_t>(y - a.row_begin) * a.output_stride, 0, a.width);
+}
+
+#ifdef DMITIGR_GENICAM_X86
+
+/**
+ * The masks of `pshufb` to interleave three planes of 16 bytes of elements
+ * of `E` bytes into three chunks (`interleave`), or to deinterleave three
+ * chunks into three planes (`deinterleave`).
+ */
+template<unsigned E>
+struct Interleave3_masks final {
+  alignas(16) std::int8_t interleave[3][3][16]{}; // [chunk][plane][byte]
+  alignas(16) std::int8_t deinterleave[3][3][16]{}; // [chunk][plane][byte]
+
+  constexpr Interleave3_masks() noexcept
   {
-    return is_implemented(GX_COMMAND_TIMESTAMP_LATCH_RESET);
+    for (unsigned j{}; j < 3; ++j) {
+      for (unsigned c{}; c < 3; ++c) {
+        for (unsigned t{}; t < 16; ++t) {
+          // The byte t of the chunk j is the byte b of the element q.
+          const unsigned k{16 * j + t}, q{k / E}, b{k % E};
+          interleave[j][c][t] = static_cast<std::int8_t>(q % 3 == c ? q / 3 * E + b : 0x80);
+          // The byte t of the plane c is the byte k of the chunks.
+          const unsigned pk{(t / E * 3 + c) * E + t % E};
+          deinterleave[j][c][t] = static_cast<std::int8_t>(pk / 16 == j ? pk % 16 : 0x80);
+        }
+      }
+    }
+  }
+};
+
+template<unsigned E>
+inline constexpr Interleave3_masks<E> interleave3_masks;
+
+/// Interleaves three planes of elements of `E` bytes into 48 bytes of `out`.
+template<unsigned E>
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void interleave3(const __m128i p0, const __m128i p1, const __m128i p2,
+  std::uint8_t* const out) noexcept
+{
+  const auto& m = interleave3_masks<E>.interleave;
+  auto* const o = reinterpret_cast<__m128i*>(out);
+  for (unsigned j{}; j < 3; ++j) {
+    const auto m0 = _mm_load_si128(reinterpret_cast<const __m128i*>(m[j][0]));
+    const auto m1 = _mm_load_si128(reinterpret_cast<const __m128i*>(m[j][1]));
+    const auto m2 = _mm_load_si128(reinterpret_cast<const __m128i*>(m[j][2]));
+    _mm_storeu_si128(o + j, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(p0, m0),
+          _mm_shuffle_epi8(p1, m1)), _mm_shuffle_epi8(p2, m2)));
+  }
+}
+
+/// Deinterleaves 48 bytes of `in` into three planes of elements of `E` bytes.
+template<unsigned E>
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void deinterleave3(const std::uint8_t* const in, __m128i (&planes)[3]) noexcept
+{
+  const auto& m = interleave3_masks<E>.deinterleave;
+  const auto* const i = reinterpret_cast<const __m128i*>(in);
+  const auto c0 = _mm_loadu_si128(i);
+  const auto c1 = _mm_loadu_si128(i + 1);
+  const auto c2 = _mm_loadu_si128(i + 2);
+  for (unsigned c{}; c < 3; ++c) {
+    const auto m0 = _mm_load_si128(reinterpret_cast<const __m128i*>(m[0][c]));
+    const auto m1 = _mm_load_si128(reinterpret_cast<const __m128i*>(m[1][c]));
+    const auto m2 = _mm_load_si128(reinterpret_cast<const __m128i*>(m[2][c]));
+    planes[c] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, m0),
+        _mm_shuffle_epi8(c1, m1)), _mm_shuffle_epi8(c2, m2));
+  }
+}
+
+/**
+ * Writes 16 pixels of the planes to `out`: 48 bytes if `count == 3`, or
+ * 64 bytes with opaque alpha otherwise.
+ */
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void store_pixels(const __m128i p0, const __m128i p1, const __m128i p2,
+  const unsigned count, std::uint8_t* const out) noexcept
+{
+  if (count == 3)
+    interleave3<1>(p0, p1, p2, out);
+  else {
+    auto* const o = reinterpret_cast<__m128i*>(out);
+    const auto alpha = _mm_set1_epi8(-1);
+    const auto lo01 = _mm_unpacklo_epi8(p0, p1);
+    const auto hi01 = _mm_unpackhi_epi8(p0, p1);
+    const auto lo2a = _mm_unpacklo_epi8(p2, alpha);
+    const auto hi2a = _mm_unpackhi_epi8(p2, alpha);
+    _mm_storeu_si128(o, _mm_unpacklo_epi16(lo01, lo2a));
+    _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo01, lo2a));
+    _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi01, hi2a));
+    _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi01, hi2a));
+  }
+}
+
+/**
+ * @returns 16 samples of the `row` starting from `x` reduced to 8 bits by
+ * the `shift` (if `bytes == 2`).
+ */
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline __m128i load_u8x16(const std::uint8_t* const row, const std::uint32_t x,
+  const unsigned bytes, const __m128i shift) noexcept
+{
+  if (bytes == 1)
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+
+  const auto* const p = reinterpret_cast<const __m128i*>(row + 2 * std::size_t{x});
+  return _mm_packus_epi16(_mm_srl_epi16(_mm_loadu_si128(p), shift),
+    _mm_srl_epi16(_mm_loadu_si128(p + 1), shift));
+}
+
+/// @returns 8 samples of the `row` starting from `x` as 16-bit values.
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline __m128i load_u16x8(const std::uint8_t* const row, const std::uint32_t x,
+  const unsigned bytes) noexcept
+{
+  return bytes == 1 ?
+    _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x))) :
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 2 * std::size_t{x}));
+}
+
+/// Demosaics the green channel to the monochrome output like green_pixels_scalar().
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void green_sse41(const Conversion_args& a) noexcept
+{
+  const auto w = a.width;
+  const auto bytes = a.input_bytes;
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(a.significant_bits - 8));
+  const auto align = _mm_cvtsi32_si128(static_cast<int>(16 - a.significant_bits));
+  for (auto y = a.row_begin; y < a.row_end; ++y) {
+    const auto r = demosaic_row(a, y);
+    std::uint32_t x{1};
+    if (a.output_format == Output_format::mono8) {
+      const auto own = r.own_parity ? _mm_set1_epi16(0x00ff) : _mm_set1_epi16(-256);
+      for (; x + 17 <= w; x += 16) {
+        const auto h = _mm_avg_epu8(load_u8x16(r.cur, x - 1, bytes, shift),
+          load_u8x16(r.cur, x + 1, bytes, shift));
+        const auto v = _mm_avg_epu8(load_u8x16(r.up, x, bytes, shift),
+          load_u8x16(r.down, x, bytes, shift));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(r.out + x),
+          _mm_blendv_epi8(load_u8x16(r.cur, x, bytes, shift), _mm_avg_epu8(h, v), own));
+      }
+    } else {
+      const auto own = r.own_parity ? _mm_set1_epi32(0x0000ffff) : _mm_set1_epi32(-65536);
+      for (; x + 9 <= w; x += 8) {
+        const auto h = _mm_avg_epu16(load_u16x8(r.cur, x - 1, bytes),
+          load_u16x8(r.cur, x + 1, bytes));
+        const auto v = _mm_avg_epu16(load_u16x8(r.up, x, bytes),
+          load_u16x8(r.down, x, bytes));
+        const auto g = _mm_blendv_epi8(load_u16x8(r.cur, x, bytes), _mm_avg_epu16(h, v), own);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(r.out + 2 * std::size_t{x}),
+          _mm_sll_epi16(g, align));
+      }
+    }
+    demosaic_pixels_scalar(a, r, 0, 1);
+    demosaic_pixels_scalar(a, r, x, w);
+  }
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void demosaic_sse41(const Conversion_args& a) noexcept
+{
+  if (is_mono(a.output_format))
+    return green_sse41(a);
+
+  const auto w = a.width;
+  const auto bytes = a.input_bytes;
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(a.significant_bits - 8));
+  const auto ch = channel_layout(a.output_format);
+  for (auto y = a.row_begin; y < a.row_end; ++y) {
+    const auto r = demosaic_row(a, y);
+    // Lanes which are at the own parity: lane i is at column x + i, x is odd.
+    const auto own = r.own_parity ? _mm_set1_epi16(0x00ff) : _mm_set1_epi16(-256);
+    std::uint32_t x{1};
+    for (; x + 17 <= w; x += 16) {
+      const auto p = load_u8x16(r.cur, x, bytes, shift);
+      const auto l = load_u8x16(r.cur, x - 1, bytes, shift);
+      const auto rt = load_u8x16(r.cur, x + 1, bytes, shift);
+      const auto u = load_u8x16(r.up, x, bytes, shift);
+      const auto ul = load_u8x16(r.up, x - 1, bytes, shift);
+      const auto ur = load_u8x16(r.up, x + 1, bytes, shift);
+      const auto d = load_u8x16(r.down, x, bytes, shift);
+      const auto dl = load_u8x16(r.down, x - 1, bytes, shift);
+      const auto dr = load_u8x16(r.down, x + 1, bytes, shift);
+      const auto h = _mm_avg_epu8(l, rt);
+      const auto v = _mm_avg_epu8(u, d);
+      const auto plus = _mm_avg_epu8(h, v);
+      const auto diag = _mm_avg_epu8(_mm_avg_epu8(ul, ur), _mm_avg_epu8(dl, dr));
+      const auto c0 = _mm_blendv_epi8(h, p, own);
+      const auto g = _mm_blendv_epi8(p, plus, own);
+      const auto c1 = _mm_blendv_epi8(v, diag, own);
+      const auto red = r.is_red_row ? c0 : c1;
+      const auto blue = r.is_red_row ? c1 : c0;
+      store_pixels(ch.red ? blue : red, g, ch.red ? red : blue, ch.count,
+        r.out + ch.count * std::size_t{x});
+    }
+    demosaic_pixels_scalar(a, r, 0, 1);
+    demosaic_pixels_scalar(a, r, x, w);
+  }
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void mono_sse41(const Conversion_args& a) noexcept
+{
+  const auto w = a.width;
+  const auto bytes = a.input_bytes;
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(a.significant_bits - 8));
+  const auto up = _mm_cvtsi32_si128(static_cast<int>(16 - a.significant_bits));
+  const auto count = bytes_per_pixel(a.output_format);
+  for (auto y = a.row_begin; y < a.row_end; ++y) {
+    const auto* const in = a.input + y * a.input_stride;
+    auto* const out = a.output + static_cast<std::ptrdiff_t>(y - a.row_begin) * a.output_stride;
+    std::uint32_t x{};
+    switch (a.output_format) {
+    case Output_format::mono8:
+      for (; x + 16 <= w; x += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x),
+          load_u8x16(in, x, bytes, shift));
+      break;
+    case Output_format::mono16:
+      for (; x + 16 <= w; x += 16) {
+        __m128i lo, hi;
+        if (bytes == 1) {
+          const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x));
+          lo = _mm_unpacklo_epi8(_mm_setzero_si128(), v);
+          hi = _mm_unpackhi_epi8(_mm_setzero_si128(), v);
+        } else {
+          const auto* const p = reinterpret_cast<const __m128i*>(in + 2 * std::size_t{x});
+          lo = _mm_sll_epi16(_mm_loadu_si128(p), up);
+          hi = _mm_sll_epi16(_mm_loadu_si128(p + 1), up);
+        }
+        auto* const o = reinterpret_cast<__m128i*>(out + 2 * std::size_t{x});
+        _mm_storeu_si128(o, lo);
+        _mm_storeu_si128(o + 1, hi);
+      }
+      break;
+    default:
+      for (; x + 16 <= w; x += 16) {
+        const auto v = load_u8x16(in, x, bytes, shift);
+        store_pixels(v, v, v, count, out + count * std::size_t{x});
+      }
+    }
+    mono_pixels_scalar(a, in, out, x, w);
+  }
+}
+
+/// @returns 32 samples like load_u8x16().
+DMITIGR_GENICAM_TARGET("avx2")
+inline __m256i load_u8x32(const std::uint8_t* const row, const std::uint32_t x,
+  const unsigned bytes, const __m128i shift) noexcept
+{
+  if (bytes == 1)
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+
+  const auto* const p = reinterpret_cast<const __m256i*>(row + 2 * std::size_t{x});
+  const auto packed = _mm256_packus_epi16(_mm256_srl_epi16(_mm256_loadu_si256(p), shift),
+    _mm256_srl_epi16(_mm256_loadu_si256(p + 1), shift));
+  // packus works within 128-bit lanes.
+  return _mm256_permute4x64_epi64(packed, 0xd8);
+}
+
+/// @returns 16 samples like load_u16x8().
+DMITIGR_GENICAM_TARGET("avx2")
+inline __m256i load_u16x16(const std::uint8_t* const row, const std::uint32_t x,
+  const unsigned bytes) noexcept
+{
+  return bytes == 1 ?
+    _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x))) :
+    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 2 * std::size_t{x}));
+}
+
+/// Writes 32 pixels of the planes like store_pixels().
+DMITIGR_GENICAM_TARGET("avx2")
+inline void store_pixels(const __m256i p0, const __m256i p1, const __m256i p2,
+  const unsigned count, std::uint8_t* const out) noexcept
+{
+  store_pixels(_mm256_castsi256_si128(p0), _mm256_castsi256_si128(p1),
+    _mm256_castsi256_si128(p2), count, out);
+  store_pixels(_mm256_extracti128_si256(p0, 1), _mm256_extracti128_si256(p1, 1),
+    _mm256_extracti128_si256(p2, 1), count, out + 16 * count);
+}
+
+/// Demosaics the green channel to the monochrome output like green_pixels_scalar().
+DMITIGR_GENICAM_TARGET("avx2")
+inline void green_avx2(const Conversion_args& a) noexcept
+{
+  const auto w = a.width;
+  const auto bytes = a.input_bytes;
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(a.significant_bits - 8));
+  const auto align = _mm_cvtsi32_si128(static_cast<int>(16 - a.significant_bits));
+  for (auto y = a.row_begin; y < a.row_end; ++y) {
+    const auto r = demosaic_row(a, y);
+    std::uint32_t x{1};
+    if (a.output_format == Output_format::mono8) {
+      const auto own = r.own_parity ? _mm256_set1_epi16(0x00ff) : _mm256_set1_epi16(-256);
+      for (; x + 33 <= w; x += 32) {
+        const auto h = _mm256_avg_epu8(load_u8x32(r.cur, x - 1, bytes, shift),
+          load_u8x32(r.cur, x + 1, bytes, shift));
+        const auto v = _mm256_avg_epu8(load_u8x32(r.up, x, bytes, shift),
+          load_u8x32(r.down, x, bytes, shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r.out + x),
+          _mm256_blendv_epi8(load_u8x32(r.cur, x, bytes, shift), _mm256_avg_epu8(h, v), own));
+      }
+    } else {
+      const auto own = r.own_parity ? _mm256_set1_epi32(0x0000ffff) : _mm256_set1_epi32(-65536);
+      for (; x + 17 <= w; x += 16) {
+        const auto h = _mm256_avg_epu16(load_u16x16(r.cur, x - 1, bytes),
+          load_u16x16(r.cur, x + 1, bytes));
+        const auto v = _mm256_avg_epu16(load_u16x16(r.up, x, bytes),
+          load_u16x16(r.down, x, bytes));
+        const auto g = _mm256_blendv_epi8(load_u16x16(r.cur, x, bytes),
+          _mm256_avg_epu16(h, v), own);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r.out + 2 * std::size_t{x}),
+          _mm256_sll_epi16(g, align));
+      }
+    }
+    demosaic_pixels_scalar(a, r, 0, 1);
+    demosaic_pixels_scalar(a, r, x, w);
+  }
+}
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void demosaic_avx2(const Conversion_args& a) noexcept
+{
+  if (is_mono(a.output_format))
+    return green_avx2(a);
+
+  const auto w = a.width;
+  const auto bytes = a.input_bytes;
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(a.significant_bits - 8));
+  const auto ch = channel_layout(a.output_format);
+  for (auto y = a.row_begin; y < a.row_end; ++y) {
+    const auto r = demosaic_row(a, y);
+    const auto own = r.own_parity ? _mm256_set1_epi16(0x00ff) : _mm256_set1_epi16(-256);
+    std::uint32_t x{1};
+    for (; x + 33 <= w; x += 32) {
+      const auto p = load_u8x32(r.cur, x, bytes, shift);
+      const auto l = load_u8x32(r.cur, x - 1, bytes, shift);
+      const auto rt = load_u8x32(r.cur, x + 1, bytes, shift);
+      const auto u = load_u8x32(r.up, x, bytes, shift);
+      const auto ul = load_u8x32(r.up, x - 1, bytes, shift);
+      const auto ur = load_u8x32(r.up, x + 1, bytes, shift);
+      const auto d = load_u8x32(r.down, x, bytes, shift);
+      const auto dl = load_u8x32(r.down, x - 1, bytes, shift);
+      const auto dr = load_u8x32(r.down, x + 1, bytes, shift);
+      const auto h = _mm256_avg_epu8(l, rt);
+      const auto v = _mm256_avg_epu8(u, d);
+      const auto plus = _mm256_avg_epu8(h, v);
+      const auto diag = _mm256_avg_epu8(_mm256_avg_epu8(ul, ur), _mm256_avg_epu8(dl, dr));
+      const auto c0 = _mm256_blendv_epi8(h, p, own);
+      const auto g = _mm256_blendv_epi8(p, plus, own);
+      const auto c1 = _mm256_blendv_epi8(v, diag, own);
+      const auto red = r.is_red_row ? c0 : c1;
+      const auto blue = r.is_red_row ? c1 : c0;
+      store_pixels(ch.red ? blue : red, g, ch.red ? red : blue, ch.count,
+        r.out + ch.count * std::size_t{x});
+    }
+    demosaic_pixels_scalar(a, r, 0, 1);
+    demosaic_pixels_scalar(a, r, x, w);
+  }
+}
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void mono_avx2(const Conversion_args& a) noexcept
+{
+  const auto w = a.width;
+  const auto bytes = a.input_bytes;
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(a.significant_bits - 8));
+  const auto up = _mm_cvtsi32_si128(static_cast<int>(16 - a.significant_bits));
+  const auto count = bytes_per_pixel(a.output_format);
+  for (auto y = a.row_begin; y < a.row_end; ++y) {
+    const auto* const in = a.input + y * a.input_stride;
+    auto* const out = a.output + static_cast<std::ptrdiff_t>(y - a.row_begin) * a.output_stride;
+    std::uint32_t x{};
+    switch (a.output_format) {
+    case Output_format::mono8:
+      for (; x + 32 <= w; x += 32)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x),
+          load_u8x32(in, x, bytes, shift));
+      break;
+    case Output_format::mono16:
+      for (; x + 32 <= w; x += 32) {
+        __m256i lo, hi;
+        if (bytes == 1) {
+          const auto* const p = reinterpret_cast<const __m128i*>(in + x);
+          lo = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(p)), 8);
+          hi = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(p + 1)), 8);
+        } else {
+          const auto* const p = reinterpret_cast<const __m256i*>(in + 2 * std::size_t{x});
+          lo = _mm256_sll_epi16(_mm256_loadu_si256(p), up);
+          hi = _mm256_sll_epi16(_mm256_loadu_si256(p + 1), up);
+        }
+        auto* const o = reinterpret_cast<__m256i*>(out + 2 * std::size_t{x});
+        _mm256_storeu_si256(o, lo);
+        _mm256_storeu_si256(o + 1, hi);
+      }
+      break;
+    default:
+      for (; x + 32 <= w; x += 32) {
+        const auto v = load_u8x32(in, x, bytes, shift);
+        store_pixels(v, v, v, count, out + count * std::size_t{x});
+      }
+    }
+    mono_pixels_scalar(a, in, out, x, w);
+  }
+}
+
+#define DMITIGR_GENICAM_DEMOSAIC demosaic_sse41, demosaic_avx2
+#define DMITIGR_GENICAM_MONO mono_sse41, mono_avx2
+#else
+#define DMITIGR_GENICAM_DEMOSAIC nullptr
+#define DMITIGR_GENICAM_MONO nullptr
+#endif
+
+/**
+ * Converts the rows of the Bayer image by bilinear interpolation (of the
+ * green channel only for the monochrome output).
+ */
+inline const Kernel<void(const Conversion_args&)> bilinear_demosaic{
+  "bilinear_demosaic", demosaic_scalar, DMITIGR_GENICAM_DEMOSAIC};
+
+/// Converts the rows of the monochrome image.
+inline const Kernel<void(const Conversion_args&)> mono_conversion{
+  "mono_conversion", mono_scalar, DMITIGR_GENICAM_MONO};
+
+#undef DMITIGR_GENICAM_DEMOSAIC
+#undef DMITIGR_GENICAM_MONO
+
+/**
+ * @returns The arguments to convert the whole image.
+ *
+ * @param input_stride The number of bytes between rows of the `input`. `0`
+ * means tightly packed.
+ * @param output_stride The number of bytes between rows of the `output`. `0`
+ * means tightly packed.
+ * @param flip `true` to flip the image vertically.
+ *
+ * @throws `std::runtime_error` if the conversion is not supported, or
+ * `std::invalid_argument` if the Bayer image is smaller than 2x2 or a stride
+ * is not a multiple of the sample size.
+ */
+inline Conversion_args conversion_args(const void* const input,
+  const GX_PIXEL_FORMAT_ENTRY input_format, void* const output,
+  const Output_format output_format, const std::uint32_t width,
+  const std::uint32_t height, const std::size_t input_stride,
+  const std::size_t output_stride, const bool flip)
+{
+  if (!is_conversion_supported(input_format, output_format))
+    throw std::runtime_error{"the conversion is not supported"};
+
+  const auto info = pixel_format_info(input_format);
+  if (info.is_bayer() && (width < 2 || height < 2))
+    throw std::invalid_argument{"invalid image size for demosaicing"};
+  else if (input_stride % info.bytes_per_channel() ||
+    (output_format == Output_format::mono16 && output_stride % 2))
+    throw std::invalid_argument{"invalid image stride"};
+
+  const auto out_stride = static_cast<std::ptrdiff_t>(output_stride ? output_stride :
+    std::size_t{width} * bytes_per_pixel(output_format));
+  Conversion_args result;
+  result.input = static_cast<const std::uint8_t*>(input);
+  result.input_bytes = info.bytes_per_channel();
+  result.input_stride = input_stride ? input_stride :
+    std::size_t{width} * result.input_bytes;
+  result.significant_bits = info.significant_bits;
+  result.bayer_layout = info.bayer_layout;
+  result.output = static_cast<std::uint8_t*>(output) +
+    (flip && height ? (height - 1) * out_stride : 0);
+  result.output_stride = flip ? -out_stride : out_stride;
+  result.output_format = output_format;
+  result.width = width;
+  result.height = height;
+  result.row_begin = 0;
+  result.row_end = height;
+  return result;
+}
+
+/**
+ * Runs the `kernel` over the rows of `args`.
+ *
+ * @param pool The thread pool to convert bands of rows in parallel, or
+ * `nullptr` to convert by the calling thread.
+ */
+inline void run_conversion(const Kernel<void(const Conversion_args&)>& kernel,
+  const Conversion_args& args, Thread_pool* const pool)
+{
+  const auto impl = kernel.selected();
+  const auto height = args.row_end;
+  if (!pool || pool->size() < 2) {
+    impl(args);
+    return;
+  }
+
+  // Bands of rows. (Several bands per worker to balance the load.)
+  const std::uint32_t band = std::max<std::uint32_t>(16,
+    height / static_cast<std::uint32_t>(pool->size() * 4) + 1);
+  const std::size_t band_count = (height + band - 1) / band;
+  pool->parallel_for(band_count, [&](const std::size_t i)
+  {
+    auto a = args;
+    a.row_begin = static_cast<std::uint32_t>(i) * band;
+    a.row_end = std::min(height, a.row_begin + band);
+    a.output += static_cast<std::ptrdiff_t>(a.row_begin) * a.output_stride;
+    impl(a);
+  });
+}
+
+/**
+ * Converts the image of the `input_format` to the image of the `output_format`
+ * in one pass by the specialized kernel for the pair of formats. Bayer images
+ * are demosaiced by bilinear interpolation (the monochrome output is the
+ * interpolated green channel, which carries most of the luma). Samples of more than 8 bits are
+ * reduced to 8 bits by dropping the least significant bits, except the
+ * `Output_format::mono16` output, which gets the samples aligned to the MSB.
+ *
+ * @param input The input image.
+ * @param output The buffer of at least `height` rows of `output_stride` bytes.
+ * @param input_stride The number of bytes between rows of the `input`. `0`
+ * means tightly packed.
+ * @param output_stride The number of bytes between rows of the `output`. `0`
+ * means tightly packed.
+ * @param flip `true` to flip the image vertically.
+ * @param pool The thread pool to convert bands of rows in parallel, or
+ * `nullptr` to convert by the calling thread.
+ *
+ * @throws `std::runtime_error` if the conversion is not supported (there are
+ * no slow fallbacks), or `std::invalid_argument` if the Bayer image is
+ * smaller than 2x2 or a stride is not a multiple of the sample size.
+ *
+ * @see is_conversion_supported().
+ */
+inline void convert(const void* const input,
+  const GX_PIXEL_FORMAT_ENTRY input_format,
+  void* const output,
+  const Output_format output_format,
+  const std::uint32_t width,
+  const std::uint32_t height,
+  const std::size_t input_stride = 0,
+  const std::size_t output_stride = 0,
+  const bool flip = false,
+  Thread_pool* const pool = nullptr)
+{
+  const auto args = conversion_args(input, input_format, output, output_format,
+    width, height, input_stride, output_stride, flip);
+  run_conversion(args.bayer_layout == NONE ? mono_conversion : bilinear_demosaic,
+    args, pool);
+}
+
+/**
+ * @overload
+ *
+ * @details The `transform` is fused into the conversion: the image is
+ * converted in bands of rows into a cache-resident buffer, and each band is
+ * transformed to the `output` right away.
+ *
+ * @param output The buffer of the transformed image, which is `height` pixels
+ * wide and `width` pixels high if is_transposing(transform).
+ */
+inline void convert(const void* const input,
+  const GX_PIXEL_FORMAT_ENTRY input_format,
+  void* const output,
+  const Output_format output_format,
+  const std::uint32_t width,
+  const std::uint32_t height,
+  const Transform transform,
+  const std::size_t input_stride = 0,
+  const std::size_t output_stride = 0,
+  Thread_pool* const pool = nullptr)
+{
+  if (transform == Transform::none || transform == Transform::flip_vertical) {
+    convert(input, input_format, output, output_format, width, height,
+      input_stride, output_stride, transform == Transform::flip_vertical, pool);
+    return;
+  }
+
+  const auto args = conversion_args(input, input_format, output, output_format,
+    width, height, input_stride, 0, false);
+  const auto element_size = bytes_per_pixel(output_format);
+  Transform_args targs;
+  targs.input_stride = std::size_t{width} * element_size;
+  targs.output = static_cast<std::uint8_t*>(output);
+  targs.output_stride = output_stride ? output_stride :
+    std::size_t{is_transposing(transform) ? height : width} * element_size;
+  targs.width = width;
+  targs.height = height;
+  targs.element_size = element_size;
+  targs.transform = transform;
+
+  const auto impl = (args.bayer_layout == NONE ? mono_conversion :
+    bilinear_demosaic).selected();
+  const auto timpl = transform_kernel.selected();
+  constexpr std::uint32_t band{16};
+  const std::size_t band_count = (height + band - 1) / band;
+  const auto process = [&](const std::size_t i)
+  {
+    thread_local std::vector<std::uint8_t> buffer;
+    auto a = args;
+    a.row_begin = static_cast<std::uint32_t>(i) * band;
+    a.row_end = std::min(height, a.row_begin + band);
+    buffer.resize((a.row_end - a.row_begin) * targs.input_stride);
+    a.output = buffer.data();
+    a.output_stride = static_cast<std::ptrdiff_t>(targs.input_stride);
+    impl(a);
+
+    auto t = targs;
+    t.input = buffer.data();
+    t.row_begin = a.row_begin;
+    t.row_end = a.row_end;
+    timpl(t);
+  };
+  if (!pool || pool->size() < 2) {
+    for (std::size_t i{}; i < band_count; ++i)
+      process(i);
+  } else
+    pool->parallel_for(band_count, process);
+}
+
+/**
+ * Converts the Bayer image of 8-bit samples to the image of 24-bit pixels by
+ * bilinear interpolation.
+ *
+ * @param input The Bayer image.
+ * @param output The buffer of at least `width * height * 3` bytes.
+ * @param bayer_layout The layout of the color filter array.
+ * @param flip `true` to flip the image vertically.
+ * @param is_bgr `true` to write the channels in the BGR order (like
+ * `DxRaw8toRGB24()` does), or `false` for RGB.
+ * @param pool The thread pool to convert bands of rows in parallel, or
+ * `nullptr` to convert by the calling thread.
+ *
+ * @par Requires
+ * `width >= 2 && height >= 2 && bayer_layout != NONE`.
+ *
+ * @see convert().
+ */
+inline void bilinear_raw8_to_rgb24(const void* const input,
+  void* const output,
+  const std::uint32_t width,
+  const std::uint32_t height,
+  const DX_PIXEL_COLOR_FILTER bayer_layout,
+  const bool flip = false,
+  const bool is_bgr = true,
+  Thread_pool* const pool = nullptr)
+{
+  if (bayer_layout == NONE)
+    throw std::invalid_argument{"invalid Bayer layout"};
+
+  convert(input, bayer_pixel_format(bayer_layout, 8), output,
+    is_bgr ? Output_format::bgr8 : Output_format::rgb8, width, height, 0, 0,
+    flip, pool);
+}
+
+// -----------------------------------------------------------------------------
+// Class Raw8_to_rgb24_converter
+// -----------------------------------------------------------------------------
+
+/**
+ * The converter of Bayer images of 8-bit samples to images of 24-bit pixels
+ * in the BGR order (like `DxRaw8toRGB24()` does) which uses the fastest
+ * method for the given image geometry.
+ *
+ * The fastest method depends on the resolution, cache sizes and memory
+ * bandwidth, so it's determined by calibrate() which benchmarks all the
+ * methods on a frame of the actual size. The winner is cached per Bayer
+ * layout and resolution.
+ *
+ * @remarks The vendor method uses `RAW2RGB_NEIGHBOUR` which is not bitwise
+ * identical to the bilinear interpolation of the native methods. Thus, it's
+ * not calibrated unless requested explicitly, so by default the output
+ * doesn't depend on the outcome of calibration.
+ *
+ * @remarks Thread-safe.
+ */
+class Raw8_to_rgb24_converter final {
+public:
+  /// A conversion method.
+  enum class Method {
+    /// `DxRaw8toRGB24()`.
+    vendor,
+    /// The portable bilinear kernel.
+    scalar,
+    /// The best SIMD bilinear kernel for the host.
+    simd,
+    /// The best bilinear kernel run by the thread pool.
+    parallel
+  };
+
+  /// The result of calibration.
+  struct Calibration final {
+    /// The fastest method.
+    Method method{Method::scalar};
+    /// The best time of each method (zero if the method was not run).
+    std::array<std::chrono::nanoseconds, 4> times{};
+  };
+
+  /**
+   * The constructor.
+   *
+   * @param pool The thread pool for Method::parallel, or `nullptr` to exclude
+   * this method from calibration.
+   * @param default_method The method for the geometries not calibrated.
+   * @param is_vendor_calibrated Whether to include Method::vendor (which
+   * output differs from the one of the other methods) into calibration.
+   */
+  explicit Raw8_to_rgb24_converter(Thread_pool* const pool = nullptr,
+    const Method default_method = Method::simd,
+    const bool is_vendor_calibrated = false)
+    : pool_{pool}
+    , default_method_{default_method}
+    , is_vendor_calibrated_{is_vendor_calibrated}
+  {}
+
+  /// @returns The string representation of the `method`.
+  static constexpr const char* to_literal(const Method method) noexcept
+  {
+    switch (method) {
+    case Method::vendor: return "vendor";
+    case Method::scalar: return "scalar";
+    case Method::simd: return "simd";
+    case Method::parallel: return "parallel";
+    }
+    return "unknown";
+  }
+
+  /**
+   * Benchmarks the methods on a synthetic frame of the given geometry and
+   * caches the fastest one. Method::vendor is benchmarked only if requested
+   * upon construction.
+   *
+   * @param iterations The number of runs of each method. The best time
+   * is taken.
+   *
+   * @returns The result of calibration.
+   *
+   * @throws The exception of the first failed method if no method succeeded
+   * (e.g. if the geometry is invalid). Nothing is cached in this case.
+   */
+  Calibration calibrate(const std::uint32_t width, const std::uint32_t height,
+    const DX_PIXEL_COLOR_FILTER bayer_layout, const unsigned iterations = 5)
+  {
+    std::vector<std::uint8_t> input(std::size_t{width} * height);
+    std::vector<std::uint8_t> output(input.size() * 3);
+    std::minstd_rand rnd;
+    for (auto& v : input)
+      v = static_cast<std::uint8_t>(rnd());
+
+    Calibration result;
+    auto best = std::chrono::nanoseconds::max();
+    std::exception_ptr error;
+    for (const auto method : {Method::vendor, Method::scalar, Method::simd, Method::parallel}) {
+      if (method == Method::vendor && !is_vendor_calibrated_)
+        continue;
+      else if (method == Method::parallel && (!pool_ || pool_->size() < 2))
+        continue;
+      else if (method == Method::simd && bilinear_demosaic.selected_level() == Simd_level::scalar)
+        continue;
+
+      auto time = std::chrono::nanoseconds::max();
+      try {
+        convert(method, input.data(), output.data(), width, height, bayer_layout, false);
+        for (unsigned i{}; i < std::max(iterations, 1u); ++i) {
+          const auto start = std::chrono::steady_clock::now();
+          convert(method, input.data(), output.data(), width, height, bayer_layout, false);
+          time = std::min(time, std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start));
+        }
+      } catch (const std::exception&) {
+        // e.g. the vendor library doesn't support the input
+        if (!error)
+          error = std::current_exception();
+        continue;
+      }
+      result.times[static_cast<unsigned>(method)] = time;
+      if (time < best) {
+        best = time;
+        result.method = method;
+      }
+    }
+    if (best == std::chrono::nanoseconds::max())
+      std::rethrow_exception(error);
+
+    const std::lock_guard lg{mutex_};
+    cache_[Key{bayer_layout, width, height}] = result.method;
+    return result;
+  }
+
+  /**
+   * @returns The calibrated method for the given geometry, or `std::nullopt`
+   * if not calibrated.
+   */
+  std::optional<Method> method(const std::uint32_t width, const std::uint32_t height,
+    const DX_PIXEL_COLOR_FILTER bayer_layout) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto i = cache_.find(Key{bayer_layout, width, height});
+    return i != cache_.end() ? std::optional<Method>{i->second} : std::nullopt;
+  }
+
+  /**
+   * Converts the image by using the calibrated method (or the default one
+   * if the geometry is not calibrated).
+   *
+   * @param output The buffer of at least `width * height * 3` bytes.
+   */
+  void convert(const void* const input, void* const output,
+    const std::uint32_t width, const std::uint32_t height,
+    const DX_PIXEL_COLOR_FILTER bayer_layout, const bool flip = false) const
+  {
+    convert(method(width, height, bayer_layout).value_or(default_method_),
+      input, output, width, height, bayer_layout, flip);
+  }
+
+  /// @overload
+  void convert(const Method method, const void* const input, void* const output,
+    const std::uint32_t width, const std::uint32_t height,
+    const DX_PIXEL_COLOR_FILTER bayer_layout, const bool flip = false) const
+  {
+    switch (method) {
+    case Method::vendor:
+      raw8_to_rgb24(const_cast<void*>(input), output, width, height,
+        RAW2RGB_NEIGHBOUR, bayer_layout, flip);
+      return;
+    case Method::scalar:
+      if (bayer_layout == NONE)
+        throw std::invalid_argument{"invalid Bayer layout"};
+      demosaic_scalar(conversion_args(input, bayer_pixel_format(bayer_layout, 8),
+          output, Output_format::bgr8, width, height, 0, 0, flip));
+      return;
+    case Method::simd:
+      bilinear_raw8_to_rgb24(input, output, width, height, bayer_layout, flip, true);
+      return;
+    case Method::parallel:
+      bilinear_raw8_to_rgb24(input, output, width, height, bayer_layout, flip, true, pool_);
+      return;
+    }
+  }
+
+private:
+  struct Key final {
+    DX_PIXEL_COLOR_FILTER bayer_layout{};
+    std::uint32_t width{};
+    std::uint32_t height{};
+
+    bool operator<(const Key& rhs) const noexcept
+    {
+      return std::tie(bayer_layout, width, height) <
+        std::tie(rhs.bayer_layout, rhs.width, rhs.height);
+    }
+  };
+
+  Thread_pool* pool_{};
+  Method default_method_{Method::simd};
+  bool is_vendor_calibrated_{};
+  mutable std::mutex mutex_;
+  std::map<Key, Method> cache_;
+};
+
+// -----------------------------------------------------------------------------
+// Tone mapping
+// -----------------------------------------------------------------------------
+
+/**
+ * The lookup table to map samples of more than 8 significant bits to 8 bits.
+ *
+ * @remarks The table is padded, so SIMD gathers of 32-bit words at any entry
+ * stay within the table.
+ */
+class Tone_lut final {
+public:
+  /**
+   * The constructor.
+   *
+   * @param significant_bits The number of significant bits of input samples.
+   * @param table The table of `2^significant_bits` entries.
+   *
+   * @par Requires
+   * `8 <= significant_bits && significant_bits <= 16`.
+   */
+  Tone_lut(const unsigned significant_bits, const std::vector<std::uint8_t>& table)
+    : Tone_lut{significant_bits}
+  {
+    if (table.size() != size())
+      throw std::invalid_argument{"invalid size of tone mapping table"};
+    std::copy(table.begin(), table.end(), table_.begin());
+  }
+
+  /**
+   * @returns The table of the gamma curve `255 * (x / max)^(1 / gamma)`.
+   *
+   * @par Requires
+   * `gamma > 0`.
+   */
+  static Tone_lut gamma(const unsigned significant_bits, const double gamma)
+  {
+    if (!(gamma > 0))
+      throw std::invalid_argument{"invalid gamma"};
+
+    const double exponent{1 / gamma};
+    return generate(significant_bits, [exponent](const double x)
+    {
+      return std::pow(x, exponent);
+    });
+  }
+
+  /**
+   * @returns The table of the logarithmic curve
+   * `255 * log(1 + strength * x / max) / log(1 + strength)`, which lifts
+   * the shadows.
+   *
+   * @par Requires
+   * `strength > 0`.
+   */
+  static Tone_lut log(const unsigned significant_bits, const double strength = 64)
+  {
+    if (!(strength > 0))
+      throw std::invalid_argument{"invalid strength of logarithmic curve"};
+
+    const double norm{1 / std::log1p(strength)};
+    return generate(significant_bits, [strength, norm](const double x)
+    {
+      return std::log1p(strength * x) * norm;
+    });
+  }
+
+  /**
+   * @returns The table which maps the window `[low, high]` linearly to the
+   * full 8-bit range and clamps the values outside the window.
+   *
+   * @par Requires
+   * `low < high`.
+   */
+  static Tone_lut linear_window(const unsigned significant_bits,
+    const std::uint32_t low, const std::uint32_t high)
+  {
+    if (!(low < high))
+      throw std::invalid_argument{"invalid window of tone mapping"};
+
+    Tone_lut result{significant_bits};
+    const double scale{255.0 / (high - low)};
+    for (std::uint32_t i{}; i < result.size(); ++i) {
+      const auto v = i <= low ? 0 : i >= high ? 255 : std::lround((i - low) * scale);
+      result.table_[i] = static_cast<std::uint8_t>(v);
+    }
+    return result;
+  }
+
+  /// @returns The number of significant bits of input samples.
+  unsigned significant_bits() const noexcept
+  {
+    return significant_bits_;
+  }
+
+  /// @returns The number of entries.
+  std::size_t size() const noexcept
+  {
+    return std::size_t{1} << significant_bits_;
+  }
+
+  /// @returns The mask of the significant bits of input samples.
+  std::uint32_t mask() const noexcept
+  {
+    return static_cast<std::uint32_t>(size() - 1);
+  }
+
+  /// @returns The value mapped to `value` (with insignificant bits ignored).
+  std::uint8_t operator[](const std::uint32_t value) const noexcept
+  {
+    return table_[value & mask()];
+  }
+
+  /// @returns The table.
+  const std::uint8_t* data() const noexcept
+  {
+    return table_.data();
+  }
+
+private:
+  /// The padding to gather 32-bit words.
+  static constexpr std::size_t padding_{3};
+
+  unsigned significant_bits_{};
+  std::vector<std::uint8_t> table_;
+
+  explicit Tone_lut(const unsigned significant_bits)
+    : significant_bits_{significant_bits}
+  {
+    if (significant_bits < 8 || significant_bits > 16)
+      throw std::invalid_argument{"invalid number of significant bits"};
+    table_.resize(size() + padding_);
+  }
+
+  /// @returns The table of `255 * curve(x / max)`.
+  template<typename F>
+  static Tone_lut generate(const unsigned significant_bits, F&& curve)
+  {
+    Tone_lut result{significant_bits};
+    const double max = result.mask();
+    for (std::uint32_t i{}; i < result.size(); ++i) {
+      const auto v = std::lround(255 * curve(i / max));
+      result.table_[i] = static_cast<std::uint8_t>(std::clamp<long>(v, 0, 255));
+    }
+    return result;
+  }
+};
+
+/**
+ * Maps `size` samples of `input` to `output` by the table `lut` which entries
+ * are addressed by the samples masked with `mask`.
+ *
+ * @remarks `output` may be equal to `input` (in place).
+ */
+inline void tone_map_scalar(const std::uint16_t* const input, const std::size_t size,
+  std::uint8_t* const output, const std::uint8_t* const lut,
+  const std::uint32_t mask) noexcept
+{
+  for (std::size_t i{}; i < size; ++i)
+    output[i] = lut[input[i] & mask];
+}
+
+#ifdef DMITIGR_GENICAM_X86
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void tone_map_avx2(const std::uint16_t* const input, const std::size_t size,
+  std::uint8_t* const output, const std::uint8_t* const lut,
+  const std::uint32_t mask) noexcept
+{
+  const auto m = _mm256_set1_epi32(static_cast<int>(mask));
+  const auto byte = _mm256_set1_epi32(0xff);
+  const auto* const base = reinterpret_cast<const int*>(lut);
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto* const p = reinterpret_cast<const __m128i*>(input + i);
+    const auto lo = _mm256_and_si256(_mm256_cvtepu16_epi32(_mm_loadu_si128(p)), m);
+    const auto hi = _mm256_and_si256(_mm256_cvtepu16_epi32(_mm_loadu_si128(p + 1)), m);
+    const auto glo = _mm256_and_si256(_mm256_i32gather_epi32(base, lo, 1), byte);
+    const auto ghi = _mm256_and_si256(_mm256_i32gather_epi32(base, hi, 1), byte);
+    // packus works within 128-bit lanes.
+    const auto w = _mm256_permute4x64_epi64(_mm256_packus_epi32(glo, ghi), 0xd8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+      _mm_packus_epi16(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1)));
   }
+  tone_map_scalar(input + i, size - i, output + i, lut, mask);
+}
 
-  /**
-   * First latchs the current timestamp value, then resets the timestamp
-   * counter and recounts from zero.
-   */
-  void latch_reset_timestamp()
-  {
-    call(GXSendCommand, handle_, GX_COMMAND_TIMESTAMP_LATCH_RESET);
+DMITIGR_GENICAM_TARGET("avx512f,avx512bw")
+inline void tone_map_avx512(const std::uint16_t* const input, const std::size_t size,
+  std::uint8_t* const output, const std::uint8_t* const lut,
+  const std::uint32_t mask) noexcept
+{
+  // The masked forms avoid false -Wmaybe-uninitialized of some GCC versions.
+  constexpr __mmask16 all{0xffff};
+  const auto m = _mm512_set1_epi32(static_cast<int>(mask));
+  const auto zero = _mm512_setzero_si512();
+  std::size_t i{};
+  for (; i + 32 <= size; i += 32) {
+    const auto* const p = reinterpret_cast<const __m256i*>(input + i);
+    const auto lo = _mm512_and_si512(_mm512_maskz_cvtepu16_epi32(all, _mm256_loadu_si256(p)), m);
+    const auto hi = _mm512_and_si512(_mm512_maskz_cvtepu16_epi32(all, _mm256_loadu_si256(p + 1)), m);
+    const auto glo = _mm512_mask_i32gather_epi32(zero, all, lo, lut, 1);
+    const auto ghi = _mm512_mask_i32gather_epi32(zero, all, hi, lut, 1);
+    auto* const o = reinterpret_cast<__m128i*>(output + i);
+    _mm_storeu_si128(o, _mm512_maskz_cvtepi32_epi8(all, glo));
+    _mm_storeu_si128(o + 1, _mm512_maskz_cvtepi32_epi8(all, ghi));
   }
+  tone_map_scalar(input + i, size - i, output + i, lut, mask);
+}
 
-  /// @}
+#define DMITIGR_GENICAM_TONE_MAP nullptr, tone_map_avx2, tone_map_avx512
+#else
+#define DMITIGR_GENICAM_TONE_MAP nullptr
+#endif
 
-  /// @name Image format
-  /// @{
+/**
+ * Maps the samples by the lookup table. (SIMD implementations gather the
+ * table entries, SSE4.1 has no gathers so it falls back to the scalar one.)
+ */
+inline const Kernel<void(const std::uint16_t*, std::size_t, std::uint8_t*,
+  const std::uint8_t*, std::uint32_t)> tone_map_u16{"tone_map_u16",
+  tone_map_scalar, DMITIGR_GENICAM_TONE_MAP};
 
-  bool is_pixel_format_implemented() const
-  {
-    return is_implemented(GX_ENUM_PIXEL_FORMAT);
+#undef DMITIGR_GENICAM_TONE_MAP
+
+/**
+ * Maps the image of samples of more than 8 significant bits (Mono10/12/16 or
+ * Bayer10/12/16) to the image of 8-bit samples by the lookup table.
+ *
+ * @param input The image of 16-bit samples.
+ * @param output The buffer of at least `height` rows of `output_stride`
+ * bytes. May be equal to `input` (in place) if `output_stride` is not
+ * greater than `input_stride`.
+ * @param lut The table which must be made for the number of significant bits
+ * of the input samples.
+ * @param input_stride The number of bytes between rows of the `input`. `0`
+ * means tightly packed.
+ * @param output_stride The number of bytes between rows of the `output`. `0`
+ * means tightly packed.
+ */
+inline void tone_map(const void* const input, void* const output,
+  const std::uint32_t width, const std::uint32_t height, const Tone_lut& lut,
+  std::size_t input_stride = 0, std::size_t output_stride = 0)
+{
+  if (!input_stride)
+    input_stride = std::size_t{width} * 2;
+  if (!output_stride)
+    output_stride = width;
+  if (input_stride % 2)
+    throw std::invalid_argument{"invalid image stride"};
+  else if (input == output && output_stride > input_stride)
+    throw std::invalid_argument{"invalid stride for tone mapping in place"};
+
+  const auto kernel = tone_map_u16.selected();
+  const auto* const in = static_cast<const std::uint8_t*>(input);
+  auto* const out = static_cast<std::uint8_t*>(output);
+  for (std::uint32_t y{}; y < height; ++y)
+    kernel(reinterpret_cast<const std::uint16_t*>(in + y * input_stride), width,
+      out + y * output_stride, lut.data(), lut.mask());
+}
+
+// -----------------------------------------------------------------------------
+// Resize
+// -----------------------------------------------------------------------------
+
+/// The number of fractional bits of the weights of bilinear interpolation.
+constexpr unsigned resize_weight_bits{7};
+
+/// Adds `size` samples of `row` to `sums`.
+inline void accumulate_row_scalar(const std::uint8_t* const row,
+  const std::size_t size, std::uint16_t* const sums) noexcept
+{
+  for (std::size_t i{}; i < size; ++i)
+    sums[i] = static_cast<std::uint16_t>(sums[i] + row[i]);
+}
+
+/**
+ * Writes `size` samples of the rows `row0` and `row1` (of the samples scaled
+ * by `2^resize_weight_bits`) blended by the `weight` of `row1`.
+ */
+inline void blend_rows_scalar(const std::uint16_t* const row0,
+  const std::uint16_t* const row1, const std::size_t size,
+  const std::uint32_t weight, std::uint8_t* const output) noexcept
+{
+  constexpr unsigned shift{2 * resize_weight_bits};
+  constexpr std::uint32_t one{1u << resize_weight_bits}, round{1u << (shift - 1)};
+  for (std::size_t i{}; i < size; ++i)
+    output[i] = static_cast<std::uint8_t>((row0[i] * (one - weight) +
+        row1[i] * weight + round) >> shift);
+}
+
+/**
+ * Writes `size` samples, each of which is the rounded mean of the `ratio`
+ * samples of `sums` (spaced by `channel_count`) divided by the `multiplier`
+ * as `((sum + half) * multiplier) >> 32`.
+ *
+ * @par Requires
+ * `size % channel_count == 0`.
+ */
+inline void reduce_row_scalar(const std::uint16_t* sums, const std::size_t size,
+  const std::uint32_t ratio, const unsigned channel_count, const std::uint32_t half,
+  const std::uint64_t multiplier, std::uint8_t* const output) noexcept
+{
+  const auto c = channel_count;
+  for (std::size_t j{}; j < size; j += c) {
+    for (unsigned k{}; k < c; ++k) {
+      std::uint32_t sum{};
+      for (std::uint32_t i{}; i < ratio; ++i)
+        sum += sums[i * c + k];
+      output[j + k] = static_cast<std::uint8_t>(((sum + half) * multiplier) >> 32);
+    }
+    sums += ratio * c;
   }
+}
 
-  void set_pixel_format(const GX_PIXEL_FORMAT_ENTRY value)
-  {
-    set_enum(GX_ENUM_PIXEL_FORMAT, value);
+/**
+ * Writes `size` samples interpolated between the samples `row[offsets[i]]`
+ * and `row[offsets[i] + step]` by the `weights[i]` of the latter (scaled by
+ * `2^resize_weight_bits`).
+ */
+inline void interpolate_row_scalar(const std::uint8_t* const row,
+  const std::size_t, const std::uint32_t* const offsets,
+  const std::uint8_t* const weights, const std::size_t size,
+  const unsigned step, std::uint16_t* const output) noexcept
+{
+  constexpr std::uint32_t one{1u << resize_weight_bits};
+  for (std::size_t i{}; i < size; ++i) {
+    const auto* const p = row + offsets[i];
+    const std::uint32_t w{weights[i]};
+    output[i] = static_cast<std::uint16_t>(p[0] * (one - w) + p[step] * w);
   }
+}
 
-  GX_PIXEL_FORMAT_ENTRY pixel_format() const
-  {
-    return static_cast<GX_PIXEL_FORMAT_ENTRY>(get_enum(GX_ENUM_PIXEL_FORMAT));
+#ifdef DMITIGR_GENICAM_X86
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void accumulate_row_sse41(const std::uint8_t* const row,
+  const std::size_t size, std::uint16_t* const sums) noexcept
+{
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+    auto* const s = reinterpret_cast<__m128i*>(sums + i);
+    _mm_storeu_si128(s, _mm_add_epi16(_mm_loadu_si128(s), _mm_cvtepu8_epi16(v)));
+    _mm_storeu_si128(s + 1, _mm_add_epi16(_mm_loadu_si128(s + 1),
+        _mm_cvtepu8_epi16(_mm_srli_si128(v, 8))));
   }
+  accumulate_row_scalar(row + i, size - i, sums + i);
+}
 
-  /// @}
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void blend_rows_sse41(const std::uint16_t* const row0,
+  const std::uint16_t* const row1, const std::size_t size,
+  const std::uint32_t weight, std::uint8_t* const output) noexcept
+{
+  constexpr unsigned shift{2 * resize_weight_bits};
+  constexpr std::uint32_t one{1u << resize_weight_bits};
+  const auto w = _mm_set1_epi32(static_cast<int>(weight << 16 | (one - weight)));
+  const auto round = _mm_set1_epi32(1 << (shift - 1));
+  std::size_t i{};
+  for (; i + 8 <= size; i += 8) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i));
+    const auto lo = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), w), round), shift);
+    const auto hi = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), w), round), shift);
+    const auto p = _mm_packs_epi32(lo, hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(p, p));
+  }
+  blend_rows_scalar(row0 + i, row1 + i, size - i, weight, output + i);
+}
 
-  /// @name Transport layer
-  /// @{
+DMITIGR_GENICAM_TARGET("avx2")
+inline void accumulate_row_avx2(const std::uint8_t* const row,
+  const std::size_t size, std::uint16_t* const sums) noexcept
+{
+  std::size_t i{};
+  for (; i + 32 <= size; i += 32) {
+    const auto* const r = reinterpret_cast<const __m128i*>(row + i);
+    auto* const s = reinterpret_cast<__m256i*>(sums + i);
+    _mm256_storeu_si256(s, _mm256_add_epi16(_mm256_loadu_si256(s),
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(r))));
+    _mm256_storeu_si256(s + 1, _mm256_add_epi16(_mm256_loadu_si256(s + 1),
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(r + 1))));
+  }
+  accumulate_row_scalar(row + i, size - i, sums + i);
+}
 
-  /// @returns The number of bytes transferred for each image or chunk on the stream channel.
-  std::int64_t payload_size() const
-  {
-    return get_int(GX_INT_PAYLOAD_SIZE);
+DMITIGR_GENICAM_TARGET("avx2")
+inline void blend_rows_avx2(const std::uint16_t* const row0,
+  const std::uint16_t* const row1, const std::size_t size,
+  const std::uint32_t weight, std::uint8_t* const output) noexcept
+{
+  constexpr unsigned shift{2 * resize_weight_bits};
+  constexpr std::uint32_t one{1u << resize_weight_bits};
+  const auto w = _mm256_set1_epi32(static_cast<int>(weight << 16 | (one - weight)));
+  const auto round = _mm256_set1_epi32(1 << (shift - 1));
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + i));
+    const auto lo = _mm256_srli_epi32(_mm256_add_epi32(
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w), round), shift);
+    const auto hi = _mm256_srli_epi32(_mm256_add_epi32(
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w), round), shift);
+    // The unpacks and packs work within 128-bit lanes, so the order is kept.
+    const auto p = _mm256_packs_epi32(lo, hi);
+    const auto p8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(p, p), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm256_castsi256_si128(p8));
   }
+  blend_rows_scalar(row0 + i, row1 + i, size - i, weight, output + i);
+}
 
-  /// @}
+/// Stores the low bytes of the 32-bit lanes of `v` to `output`.
+DMITIGR_GENICAM_TARGET("avx2")
+inline void store_u32_as_u8(const __m256i v, std::uint8_t* const output) noexcept
+{
+  const auto p = _mm256_packus_epi16(_mm256_packus_epi32(v, v), _mm256_setzero_si256());
+  const auto q = _mm256_permutevar8x32_epi32(p, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(q));
+}
 
-  /// @name Acquisition trigger
-  /// @{
+/**
+ * Gathers the samples to sum. Reads one sample past the last one of `sums`,
+ * so the buffer must be padded.
+ */
+DMITIGR_GENICAM_TARGET("avx2")
+inline void reduce_row_avx2(const std::uint16_t* const sums, const std::size_t size,
+  const std::uint32_t ratio, const unsigned channel_count, const std::uint32_t half,
+  const std::uint64_t multiplier, std::uint8_t* const output) noexcept
+{
+  if (multiplier > UINT32_MAX)
+    return reduce_row_scalar(sums, size, ratio, channel_count, half, multiplier, output);
+
+  // The group is a multiple of both the lane count and the channel count.
+  constexpr std::size_t group{24};
+  const auto c = channel_count;
+  alignas(32) std::int32_t indices[group];
+  for (unsigned t{}; t < group; ++t)
+    indices[t] = static_cast<std::int32_t>(t / c * ratio * c + t % c);
+  const auto* const index = reinterpret_cast<const __m256i*>(indices);
+  const __m256i base[]{_mm256_load_si256(index), _mm256_load_si256(index + 1),
+    _mm256_load_si256(index + 2)};
+  const auto step = _mm256_set1_epi32(static_cast<int>(c));
+  const auto mask = _mm256_set1_epi32(0xffff);
+  const auto h = _mm256_set1_epi32(static_cast<int>(half));
+  const auto m = _mm256_set1_epi64x(static_cast<long long>(multiplier));
+  std::size_t j{};
+  for (; j + group <= size; j += group) {
+    const auto* const s = reinterpret_cast<const int*>(sums + j * ratio);
+    for (unsigned v{}; v < 3; ++v) {
+      auto idx = base[v];
+      auto sum = h;
+      for (std::uint32_t i{}; i < ratio; ++i) {
+        sum = _mm256_add_epi32(sum,
+          _mm256_and_si256(_mm256_i32gather_epi32(s, idx, 2), mask));
+        idx = _mm256_add_epi32(idx, step);
+      }
+      // (sum * multiplier) >> 32 of even and odd lanes.
+      const auto even = _mm256_srli_epi64(_mm256_mul_epu32(sum, m), 32);
+      const auto odd = _mm256_mul_epu32(_mm256_srli_epi64(sum, 32), m);
+      store_u32_as_u8(_mm256_blend_epi32(even, odd, 0xaa), output + j + 8 * v);
+    }
+  }
+  reduce_row_scalar(sums + j * ratio, size - j, ratio, c, half, multiplier, output + j);
+}
 
-  bool is_trigger_mode_implemented() const
-  {
-    return is_implemented(GX_ENUM_TRIGGER_MODE);
+/// Gathers the samples to interpolate, stopping before reading past the row.
+DMITIGR_GENICAM_TARGET("avx2")
+inline void interpolate_row_avx2(const std::uint8_t* const row,
+  const std::size_t row_size, const std::uint32_t* const offsets,
+  const std::uint8_t* const weights, const std::size_t size,
+  const unsigned step, std::uint16_t* const output) noexcept
+{
+  constexpr std::uint32_t one{1u << resize_weight_bits};
+  const auto* const base = reinterpret_cast<const int*>(row);
+  const auto s = _mm256_set1_epi32(static_cast<int>(step));
+  const auto o = _mm256_set1_epi32(one);
+  const auto mask = _mm256_set1_epi32(0xff);
+  // The maximum offset of the 32-bit gather.
+  const auto last = _mm256_set1_epi32(static_cast<int>(row_size) - 4);
+  std::size_t i{};
+  for (; row_size >= 4 && i + 8 <= size; i += 8) {
+    const auto idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+    const auto idx1 = _mm256_add_epi32(idx0, s);
+    if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(idx1, last)))
+      break;
+
+    const auto w = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+        reinterpret_cast<const __m128i*>(weights + i)));
+    const auto a = _mm256_and_si256(_mm256_i32gather_epi32(base, idx0, 1), mask);
+    const auto b = _mm256_and_si256(_mm256_i32gather_epi32(base, idx1, 1), mask);
+    const auto r = _mm256_add_epi32(_mm256_mullo_epi32(a, _mm256_sub_epi32(o, w)),
+      _mm256_mullo_epi32(b, w));
+    const auto p = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm256_castsi256_si128(p));
   }
+  interpolate_row_scalar(row, row_size, offsets + i, weights + i, size - i, step,
+    output + i);
+}
 
-  void set_trigger_mode(const GX_TRIGGER_MODE_ENTRY value)
+#define DMITIGR_GENICAM_ACCUMULATE_ROW accumulate_row_sse41, accumulate_row_avx2
+#define DMITIGR_GENICAM_BLEND_ROWS blend_rows_sse41, blend_rows_avx2
+#define DMITIGR_GENICAM_REDUCE_ROW nullptr, reduce_row_avx2
+#define DMITIGR_GENICAM_INTERPOLATE_ROW nullptr, interpolate_row_avx2
+#else
+#define DMITIGR_GENICAM_ACCUMULATE_ROW nullptr
+#define DMITIGR_GENICAM_BLEND_ROWS nullptr
+#define DMITIGR_GENICAM_REDUCE_ROW nullptr
+#define DMITIGR_GENICAM_INTERPOLATE_ROW nullptr
+#endif
+
+/// Adds the samples of the row to the 16-bit sums.
+inline const Kernel<void(const std::uint8_t*, std::size_t, std::uint16_t*)>
+accumulate_row_u8{"accumulate_row_u8", accumulate_row_scalar,
+  DMITIGR_GENICAM_ACCUMULATE_ROW};
+
+/// Blends two rows of the scaled samples to a row of 8-bit samples.
+inline const Kernel<void(const std::uint16_t*, const std::uint16_t*, std::size_t,
+  std::uint32_t, std::uint8_t*)>
+blend_rows_u16{"blend_rows_u16", blend_rows_scalar, DMITIGR_GENICAM_BLEND_ROWS};
+
+/// Reduces the row of the 16-bit sums to a row of 8-bit means.
+inline const Kernel<void(const std::uint16_t*, std::size_t, std::uint32_t,
+  unsigned, std::uint32_t, std::uint64_t, std::uint8_t*)>
+reduce_row_u16{"reduce_row_u16", reduce_row_scalar, DMITIGR_GENICAM_REDUCE_ROW};
+
+/// Interpolates the row of 8-bit samples to a row of the scaled samples.
+inline const Kernel<void(const std::uint8_t*, std::size_t, const std::uint32_t*,
+  const std::uint8_t*, std::size_t, unsigned, std::uint16_t*)>
+interpolate_row_u8{"interpolate_row_u8", interpolate_row_scalar,
+  DMITIGR_GENICAM_INTERPOLATE_ROW};
+
+#undef DMITIGR_GENICAM_ACCUMULATE_ROW
+#undef DMITIGR_GENICAM_BLEND_ROWS
+#undef DMITIGR_GENICAM_REDUCE_ROW
+#undef DMITIGR_GENICAM_INTERPOLATE_ROW
+
+/**
+ * The plan of resizing of Gray8 or RGB24 images of the given geometry. The
+ * coefficients are computed once, so the plan should be reused for all the
+ * frames of the same geometry.
+ *
+ * @remarks Thread-safe.
+ */
+class Resize_plan final {
+public:
+  /// A resize method.
+  enum class Method {
+    /**
+     * Averaging of the areas. Requires the source size to be an integer
+     * multiple (up to 64) of the destination size.
+     */
+    area,
+    /// Bilinear interpolation (with `resize_weight_bits` of precision).
+    bilinear
+  };
+
+  /**
+   * The constructor.
+   *
+   * @param channel_count `1` for Gray8, or `3` for RGB24.
+   */
+  Resize_plan(const std::uint32_t source_width, const std::uint32_t source_height,
+    const std::uint32_t width, const std::uint32_t height,
+    const unsigned channel_count, const Method method)
+    : source_width_{source_width}
+    , source_height_{source_height}
+    , width_{width}
+    , height_{height}
+    , channel_count_{channel_count}
+    , method_{method}
   {
-    set_enum(GX_ENUM_TRIGGER_MODE, value);
+    if (!source_width || !source_height || !width || !height)
+      throw std::invalid_argument{"invalid image size for resizing"};
+    else if (channel_count != 1 && channel_count != 3)
+      throw std::invalid_argument{"invalid channel count for resizing"};
+
+    if (method == Method::area) {
+      if (source_width % width || source_height % height)
+        throw std::invalid_argument{"non-integer ratio of area resizing"};
+      area_x_ = source_width / width;
+      area_y_ = source_height / height;
+      if (area_x_ > 64 || area_y_ > 64)
+        throw std::invalid_argument{"too large ratio of area resizing"};
+      // (sum + n/2) * multiplier >> 32 is exact for sums of at most 64*64 samples.
+      const std::uint64_t n{area_x_ * area_y_};
+      area_multiplier_ = ((std::uint64_t{1} << 32) + n - 1) / n;
+    } else {
+      std::vector<std::uint32_t> offsets;
+      std::vector<std::uint8_t> weights;
+      coefficients(source_width, width, offsets, weights);
+      coefficients(source_height, height, y_offsets_, y_weights_);
+      // Expand the horizontal coefficients to the samples of all channels.
+      const auto c = channel_count;
+      x_offsets_.resize(offsets.size() * c);
+      x_weights_.resize(offsets.size() * c);
+      for (std::size_t i{}; i < x_offsets_.size(); ++i) {
+        x_offsets_[i] = offsets[i / c] * c + static_cast<std::uint32_t>(i % c);
+        x_weights_[i] = weights[i / c];
+      }
+    }
   }
 
-  GX_TRIGGER_MODE_ENTRY trigger_mode() const
+  /// @returns The source width.
+  std::uint32_t source_width() const noexcept
   {
-    return static_cast<GX_TRIGGER_MODE_ENTRY>(get_enum(GX_ENUM_TRIGGER_MODE));
+    return source_width_;
   }
 
-  bool is_trigger_source_implemented() const
+  /// @returns The source height.
+  std::uint32_t source_height() const noexcept
   {
-    return is_implemented(GX_ENUM_TRIGGER_SOURCE);
+    return source_height_;
   }
 
-  void set_trigger_source(const GX_TRIGGER_SOURCE_ENTRY value)
+  /// @returns The destination width.
+  std::uint32_t width() const noexcept
   {
-    set_enum(GX_ENUM_TRIGGER_SOURCE, value);
+    return width_;
   }
 
-  GX_TRIGGER_SOURCE_ENTRY trigger_source() const
+  /// @returns The destination height.
+  std::uint32_t height() const noexcept
   {
-    return static_cast<GX_TRIGGER_SOURCE_ENTRY>(get_enum(GX_ENUM_TRIGGER_SOURCE));
+    return height_;
   }
 
-  bool is_external_trigger_switch_implemented() const
+  /// @returns The number of channels.
+  unsigned channel_count() const noexcept
   {
-    return is_implemented(GX_ENUM_TRIGGER_SWITCH);
+    return channel_count_;
   }
 
-  void set_external_trigger_switch(const GX_TRIGGER_SWITCH_ENTRY value)
+  /// @returns The method.
+  Method method() const noexcept
   {
-    set_enum(GX_ENUM_TRIGGER_SWITCH, value);
+    return method_;
   }
 
-  GX_TRIGGER_SWITCH_ENTRY external_trigger_switch() const
+  /**
+   * Resizes the image.
+   *
+   * @param input The source image.
+   * @param output The buffer of the destination image.
+   * @param input_stride The number of bytes between rows of the `input`. `0`
+   * means tightly packed.
+   * @param output_stride The number of bytes between rows of the `output`. `0`
+   * means tightly packed.
+   */
+  void operator()(const void* const input, void* const output,
+    std::size_t input_stride = 0, std::size_t output_stride = 0) const
   {
-    return static_cast<GX_TRIGGER_SWITCH_ENTRY>(get_enum(GX_ENUM_TRIGGER_SWITCH));
+    if (!input_stride)
+      input_stride = std::size_t{source_width_} * channel_count_;
+    if (!output_stride)
+      output_stride = std::size_t{width_} * channel_count_;
+    const auto* const in = static_cast<const std::uint8_t*>(input);
+    auto* const out = static_cast<std::uint8_t*>(output);
+    if (method_ == Method::area)
+      resize_area(in, input_stride, out, output_stride);
+    else
+      resize_bilinear(in, input_stride, out, output_stride);
   }
 
-  bool is_trigger_filter_raising_implemented() const
+private:
+  std::uint32_t source_width_{};
+  std::uint32_t source_height_{};
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  unsigned channel_count_{};
+  Method method_{};
+  // Area.
+  std::uint32_t area_x_{};
+  std::uint32_t area_y_{};
+  std::uint64_t area_multiplier_{};
+  /*
+   * Bilinear: the first of the two source pixels and the weight of the second.
+   * (Per sample of the destination row for the horizontal pass.)
+   */
+  std::vector<std::uint32_t> x_offsets_;
+  std::vector<std::uint8_t> x_weights_;
+  std::vector<std::uint32_t> y_offsets_;
+  std::vector<std::uint8_t> y_weights_;
+
+  /// Computes the coefficients of bilinear interpolation along an axis.
+  static void coefficients(const std::uint32_t source_size, const std::uint32_t size,
+    std::vector<std::uint32_t>& offsets, std::vector<std::uint8_t>& weights)
   {
-    return is_implemented(GX_FLOAT_TRIGGER_FILTER_RAISING);
+    constexpr double one{1u << resize_weight_bits};
+    offsets.resize(size);
+    weights.resize(size);
+    const double scale{static_cast<double>(source_size) / size};
+    const auto last = source_size - 1;
+    for (std::uint32_t i{}; i < size; ++i) {
+      // Centers of the pixels are aligned.
+      const double pos = std::clamp((i + 0.5) * scale - 0.5, 0.0, double(last));
+      const auto first = std::min(static_cast<std::uint32_t>(pos), last ? last - 1 : 0);
+      offsets[i] = first;
+      weights[i] = last ? static_cast<std::uint8_t>(std::lround((pos - first) * one)) : 0;
+    }
   }
 
-  void set_trigger_filter_raising(const double value)
+  void resize_area(const std::uint8_t* const in, const std::size_t input_stride,
+    std::uint8_t* const out, const std::size_t output_stride) const
   {
-    set_float(GX_FLOAT_TRIGGER_FILTER_RAISING, value);
+    const auto c = channel_count_;
+    const std::size_t row_size{std::size_t{source_width_} * c};
+    const auto accumulate = accumulate_row_u8.selected();
+    const auto reduce = reduce_row_u16.selected();
+    // The padding sample is for the 32-bit gathers of reduce.
+    thread_local std::vector<std::uint16_t> sums;
+    sums.resize(row_size + 1);
+    const std::uint32_t half{area_x_ * area_y_ / 2};
+    for (std::uint32_t y{}; y < height_; ++y) {
+      std::fill(sums.begin(), sums.end(), std::uint16_t{});
+      for (std::uint32_t i{}; i < area_y_; ++i)
+        accumulate(in + (std::size_t{y} * area_y_ + i) * input_stride, row_size, sums.data());
+      reduce(sums.data(), std::size_t{width_} * c, area_x_, c, half, area_multiplier_,
+        out + y * output_stride);
+    }
   }
 
-  double trigger_filter_raising() const
+  void resize_bilinear(const std::uint8_t* const in, const std::size_t input_stride,
+    std::uint8_t* const out, const std::size_t output_stride) const
   {
-    return get_float(GX_FLOAT_TRIGGER_FILTER_RAISING);
+    const auto c = channel_count_;
+    const std::size_t row_size{std::size_t{width_} * c};
+    const unsigned x_step{source_width_ > 1 ? c : 0};
+    const std::uint32_t y_step{source_height_ > 1 ? 1u : 0u};
+    const std::size_t source_row_size{std::size_t{source_width_} * c};
+    const auto blend = blend_rows_u16.selected();
+    const auto interpolate = interpolate_row_u8.selected();
+
+    // Two horizontally resized source rows (scaled by 2^resize_weight_bits).
+    thread_local std::vector<std::uint16_t> rows;
+    rows.resize(2 * row_size);
+    std::uint16_t* cache[2]{rows.data(), rows.data() + row_size};
+    std::int64_t cached[2]{-1, -1};
+    const auto horizontal = [&](const std::uint32_t sy, std::uint16_t* const dst)
+    {
+      interpolate(in + sy * input_stride, source_row_size, x_offsets_.data(),
+        x_weights_.data(), row_size, x_step, dst);
+    };
+    const auto row = [&](const std::uint32_t sy)
+    {
+      for (unsigned i{}; i < 2; ++i) {
+        if (cached[i] == sy)
+          return cache[i];
+      }
+      // Replace the row which is not the one above sy.
+      const unsigned i{cached[0] == std::int64_t{sy} - 1 ? 1u : 0u};
+      horizontal(sy, cache[i]);
+      cached[i] = sy;
+      return cache[i];
+    };
+
+    for (std::uint32_t y{}; y < height_; ++y) {
+      const auto sy = y_offsets_[y];
+      const auto* const r0 = row(sy);
+      const auto* const r1 = row(sy + y_step);
+      blend(r0, r1, row_size, y_weights_[y], out + y * output_stride);
+    }
   }
+};
 
-  std::pair<double, double> trigger_filter_raising_range() const
-  {
-    return get_float_range(GX_FLOAT_TRIGGER_FILTER_RAISING);
+// -----------------------------------------------------------------------------
+// Flat-field correction
+// -----------------------------------------------------------------------------
+
+/// The number of fractional bits of the gains of flat-field correction.
+constexpr unsigned flat_field_gain_bits{12};
+
+/**
+ * Corrects `size` samples: `min(max, (max(in - dark, 0) * gain) >> bits)`
+ * (with rounding), where `bits` is `flat_field_gain_bits`.
+ *
+ * @remarks `output` may be equal to `input` (in place).
+ */
+template<typename T>
+inline void flat_field_scalar(const T* const input, const std::size_t size,
+  const std::uint16_t* const dark, const std::uint16_t* const gain,
+  T* const output, const std::uint16_t max) noexcept
+{
+  constexpr std::uint32_t round{1u << (flat_field_gain_bits - 1)};
+  for (std::size_t i{}; i < size; ++i) {
+    const std::uint32_t d = input[i] > dark[i] ? input[i] - dark[i] : 0;
+    const auto v = (d * gain[i] + round) >> flat_field_gain_bits;
+    output[i] = static_cast<T>(std::min<std::uint32_t>(v, max));
   }
+}
 
-  bool is_trigger_filter_falling_implemented() const
+#ifdef DMITIGR_GENICAM_X86
+
+/// @returns The corrected 8 samples (see flat_field_scalar()).
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline __m128i flat_field(const __m128i input, const __m128i dark,
+  const __m128i gain, const __m128i max) noexcept
+{
+  const auto round = _mm_set1_epi32(1 << (flat_field_gain_bits - 1));
+  const auto d = _mm_subs_epu16(input, dark);
+  const auto lo = _mm_mullo_epi16(d, gain);
+  const auto hi = _mm_mulhi_epu16(d, gain);
+  const auto p0 = _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round),
+    flat_field_gain_bits);
+  const auto p1 = _mm_srli_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round),
+    flat_field_gain_bits);
+  return _mm_min_epu16(_mm_packus_epi32(p0, p1), max);
+}
+
+/// @returns The corrected 16 samples (see flat_field_scalar()).
+DMITIGR_GENICAM_TARGET("avx2")
+inline __m256i flat_field(const __m256i input, const __m256i dark,
+  const __m256i gain, const __m256i max) noexcept
+{
+  const auto round = _mm256_set1_epi32(1 << (flat_field_gain_bits - 1));
+  const auto d = _mm256_subs_epu16(input, dark);
+  const auto lo = _mm256_mullo_epi16(d, gain);
+  const auto hi = _mm256_mulhi_epu16(d, gain);
+  // The unpacks and packs work within 128-bit lanes, so the order is kept.
+  const auto p0 = _mm256_srli_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), round),
+    flat_field_gain_bits);
+  const auto p1 = _mm256_srli_epi32(_mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), round),
+    flat_field_gain_bits);
+  return _mm256_min_epu16(_mm256_packus_epi32(p0, p1), max);
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void flat_field_u8_sse41(const std::uint8_t* const input, const std::size_t size,
+  const std::uint16_t* const dark, const std::uint16_t* const gain,
+  std::uint8_t* const output, const std::uint16_t max) noexcept
+{
+  const auto m = _mm_set1_epi16(static_cast<short>(max));
+  std::size_t i{};
+  for (; i + 8 <= size; i += 8) {
+    const auto x = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i)));
+    const auto r = flat_field(x,
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(dark + i)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(gain + i)), m);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(r, r));
+  }
+  flat_field_scalar(input + i, size - i, dark + i, gain + i, output + i, max);
+}
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void flat_field_u16_sse41(const std::uint16_t* const input, const std::size_t size,
+  const std::uint16_t* const dark, const std::uint16_t* const gain,
+  std::uint16_t* const output, const std::uint16_t max) noexcept
+{
+  const auto m = _mm_set1_epi16(static_cast<short>(max));
+  std::size_t i{};
+  for (; i + 8 <= size; i += 8) {
+    const auto r = flat_field(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(dark + i)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(gain + i)), m);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), r);
+  }
+  flat_field_scalar(input + i, size - i, dark + i, gain + i, output + i, max);
+}
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void flat_field_u8_avx2(const std::uint8_t* const input, const std::size_t size,
+  const std::uint16_t* const dark, const std::uint16_t* const gain,
+  std::uint8_t* const output, const std::uint16_t max) noexcept
+{
+  const auto m = _mm256_set1_epi16(static_cast<short>(max));
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto x = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+    const auto r = flat_field(x,
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dark + i)),
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gain + i)), m);
+    const auto p = _mm256_permute4x64_epi64(_mm256_packus_epi16(r, r), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm256_castsi256_si128(p));
+  }
+  flat_field_scalar(input + i, size - i, dark + i, gain + i, output + i, max);
+}
+
+DMITIGR_GENICAM_TARGET("avx2")
+inline void flat_field_u16_avx2(const std::uint16_t* const input, const std::size_t size,
+  const std::uint16_t* const dark, const std::uint16_t* const gain,
+  std::uint16_t* const output, const std::uint16_t max) noexcept
+{
+  const auto m = _mm256_set1_epi16(static_cast<short>(max));
+  std::size_t i{};
+  for (; i + 16 <= size; i += 16) {
+    const auto r = flat_field(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)),
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dark + i)),
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gain + i)), m);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), r);
+  }
+  flat_field_scalar(input + i, size - i, dark + i, gain + i, output + i, max);
+}
+
+#define DMITIGR_GENICAM_FLAT_FIELD_U8 flat_field_u8_sse41, flat_field_u8_avx2
+#define DMITIGR_GENICAM_FLAT_FIELD_U16 flat_field_u16_sse41, flat_field_u16_avx2
+#else
+#define DMITIGR_GENICAM_FLAT_FIELD_U8 nullptr
+#define DMITIGR_GENICAM_FLAT_FIELD_U16 nullptr
+#endif
+
+/// Corrects the row of 8-bit samples.
+inline const Kernel<void(const std::uint8_t*, std::size_t, const std::uint16_t*,
+  const std::uint16_t*, std::uint8_t*, std::uint16_t)> flat_field_u8{"flat_field_u8",
+  flat_field_scalar<std::uint8_t>, DMITIGR_GENICAM_FLAT_FIELD_U8};
+
+/// Corrects the row of 16-bit samples.
+inline const Kernel<void(const std::uint16_t*, std::size_t, const std::uint16_t*,
+  const std::uint16_t*, std::uint16_t*, std::uint16_t)> flat_field_u16{"flat_field_u16",
+  flat_field_scalar<std::uint16_t>, DMITIGR_GENICAM_FLAT_FIELD_U16};
+
+#undef DMITIGR_GENICAM_FLAT_FIELD_U8
+#undef DMITIGR_GENICAM_FLAT_FIELD_U16
+
+/**
+ * The dark-frame and flat-field correction of raw frames (of monochrome or
+ * Bayer formats): `corrected = (raw - dark) * gain`, where the per-pixel
+ * `gain = mean(flat - dark) / (flat - dark)` equalizes the response of the
+ * pixels. The gains are fixed-point (with `flat_field_gain_bits` fractional
+ * bits, up to 16x) and precomputed once.
+ *
+ * @remarks Thread-safe.
+ */
+class Flat_field_correction final {
+public:
+  /**
+   * The constructor.
+   *
+   * @param significant_bits The number of significant bits of samples (`8`
+   * for raw8, or up to `16` for raw16 frames).
+   * @param dark The averaged dark frame, or empty for no dark subtraction.
+   * @param flat The averaged frame of the uniformly lit field, or empty for
+   * no gain correction.
+   * @param bayer_layout The layout of the color filter array. If not `NONE`
+   * the means are computed per color, so the white balance is kept.
+   *
+   * @see Frame_averager.
+   */
+  Flat_field_correction(const std::uint32_t width, const std::uint32_t height,
+    const unsigned significant_bits, const std::vector<std::uint16_t>& dark,
+    const std::vector<std::uint16_t>& flat = {},
+    const DX_PIXEL_COLOR_FILTER bayer_layout = NONE)
+    : width_{width}
+    , height_{height}
+    , significant_bits_{significant_bits}
   {
-    return is_implemented(GX_FLOAT_TRIGGER_FILTER_FALLING);
+    const std::size_t size{std::size_t{width} * height};
+    if (significant_bits < 8 || significant_bits > 16)
+      throw std::invalid_argument{"invalid number of significant bits"};
+    else if ((!dark.empty() && dark.size() != size) || (!flat.empty() && flat.size() != size))
+      throw std::invalid_argument{"invalid size of calibration frame"};
+
+    dark_ = dark.empty() ? std::vector<std::uint16_t>(size) : dark;
+    gain_.assign(size, std::uint16_t{1} << flat_field_gain_bits);
+    if (flat.empty())
+      return;
+
+    // The mean response per color.
+    const auto color = [&](const std::uint32_t x, const std::uint32_t y)
+    {
+      return bayer_layout == NONE ? 0 : static_cast<unsigned>(cfa_color(bayer_layout, y, x));
+    };
+    std::array<std::uint64_t, 3> sums{};
+    std::array<std::uint64_t, 3> counts{};
+    for (std::uint32_t y{}; y < height; ++y) {
+      for (std::uint32_t x{}; x < width; ++x) {
+        const auto i = std::size_t{y} * width + x;
+        const auto c = color(x, y);
+        sums[c] += flat[i] > dark_[i] ? flat[i] - dark_[i] : 0;
+        counts[c]++;
+      }
+    }
+    for (std::uint32_t y{}; y < height; ++y) {
+      for (std::uint32_t x{}; x < width; ++x) {
+        const auto i = std::size_t{y} * width + x;
+        const auto c = color(x, y);
+        const double mean = static_cast<double>(sums[c]) / static_cast<double>(counts[c]);
+        const int response = flat[i] - dark_[i];
+        if (response > 0) // dead pixels are left as is
+          gain_[i] = static_cast<std::uint16_t>(std::min<long>(65535,
+              std::lround(mean * (1 << flat_field_gain_bits) / response)));
+      }
+    }
   }
 
-  void set_trigger_filter_falling(const double value)
+  /// @returns The width of frames.
+  std::uint32_t width() const noexcept
   {
-    set_float(GX_FLOAT_TRIGGER_FILTER_FALLING, value);
+    return width_;
   }
 
-  double trigger_filter_falling() const
+  /// @returns The height of frames.
+  std::uint32_t height() const noexcept
   {
-    return get_float(GX_FLOAT_TRIGGER_FILTER_FALLING);
+    return height_;
   }
 
-  std::pair<double, double> trigger_filter_falling_range() const
+  /// @returns The number of significant bits of samples.
+  unsigned significant_bits() const noexcept
   {
-    return get_float_range(GX_FLOAT_TRIGGER_FILTER_FALLING);
+    return significant_bits_;
   }
 
-  bool is_trigger_delay_implemented() const
+  /// @returns The per-pixel dark levels.
+  const std::vector<std::uint16_t>& dark() const noexcept
   {
-    return is_implemented(GX_FLOAT_TRIGGER_DELAY);
+    return dark_;
   }
 
-  void set_trigger_delay(const double value)
+  /// @returns The per-pixel fixed-point gains.
+  const std::vector<std::uint16_t>& gain() const noexcept
   {
-    set_float(GX_FLOAT_TRIGGER_DELAY, value);
+    return gain_;
   }
 
-  double trigger_delay() const
+  /**
+   * Corrects the frame (of 8-bit samples if `significant_bits() == 8`, or
+   * 16-bit samples otherwise).
+   *
+   * @param output The buffer of the corrected frame. May be equal to `input`
+   * (in place) if the strides are equal.
+   * @param input_stride The number of bytes between rows of the `input`. `0`
+   * means tightly packed.
+   * @param output_stride The number of bytes between rows of the `output`. `0`
+   * means tightly packed.
+   */
+  void operator()(const void* const input, void* const output,
+    std::size_t input_stride = 0, std::size_t output_stride = 0) const
   {
-    return get_float(GX_FLOAT_TRIGGER_DELAY);
+    const std::size_t bytes{significant_bits_ > 8 ? 2u : 1u};
+    if (!input_stride)
+      input_stride = width_ * bytes;
+    if (!output_stride)
+      output_stride = width_ * bytes;
+    const auto max = static_cast<std::uint16_t>((1u << significant_bits_) - 1);
+    const auto* const in = static_cast<const std::uint8_t*>(input);
+    auto* const out = static_cast<std::uint8_t*>(output);
+    if (bytes == 1) {
+      const auto kernel = flat_field_u8.selected();
+      for (std::uint32_t y{}; y < height_; ++y) {
+        const auto offset = std::size_t{y} * width_;
+        kernel(in + y * input_stride, width_, dark_.data() + offset,
+          gain_.data() + offset, out + y * output_stride, max);
+      }
+    } else {
+      const auto kernel = flat_field_u16.selected();
+      for (std::uint32_t y{}; y < height_; ++y) {
+        const auto offset = std::size_t{y} * width_;
+        kernel(reinterpret_cast<const std::uint16_t*>(in + y * input_stride), width_,
+          dark_.data() + offset, gain_.data() + offset,
+          reinterpret_cast<std::uint16_t*>(out + y * output_stride), max);
+      }
+    }
   }
 
-  std::pair<double, double> trigger_delay_range() const
+private:
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  unsigned significant_bits_{};
+  std::vector<std::uint16_t> dark_;
+  std::vector<std::uint16_t> gain_;
+};
+
+/// The averager of frames to build the calibration frames.
+class Frame_averager final {
+public:
+  /**
+   * The constructor.
+   *
+   * @param significant_bits The number of significant bits of samples (`8`
+   * for frames of 8-bit samples, or up to `16` for frames of 16-bit samples).
+   */
+  Frame_averager(const std::uint32_t width, const std::uint32_t height,
+    const unsigned significant_bits)
+    : width_{width}
+    , height_{height}
+    , significant_bits_{significant_bits}
+    , sums_(std::size_t{width} * height)
   {
-    return get_float_range(GX_FLOAT_TRIGGER_DELAY);
+    if (significant_bits < 8 || significant_bits > 16)
+      throw std::invalid_argument{"invalid number of significant bits"};
   }
 
-  bool is_exposure_time_implemented() const
+  /**
+   * Adds the frame.
+   *
+   * @param stride The number of bytes between rows of the `frame`. `0` means
+   * tightly packed.
+   */
+  void add(const void* const frame, std::size_t stride = 0)
   {
-    return is_implemented(GX_FLOAT_EXPOSURE_TIME);
+    const std::size_t bytes{significant_bits_ > 8 ? 2u : 1u};
+    if (!stride)
+      stride = width_ * bytes;
+    const auto* const f = static_cast<const std::uint8_t*>(frame);
+    for (std::uint32_t y{}; y < height_; ++y) {
+      auto* const s = sums_.data() + std::size_t{y} * width_;
+      const auto* const row = f + y * stride;
+      if (bytes == 1) {
+        for (std::uint32_t x{}; x < width_; ++x)
+          s[x] += row[x];
+      } else {
+        const auto* const row16 = reinterpret_cast<const std::uint16_t*>(row);
+        for (std::uint32_t x{}; x < width_; ++x)
+          s[x] += row16[x];
+      }
+    }
+    count_++;
   }
 
-  void set_exposure_time(const double value)
+  /// @returns The width of frames.
+  std::uint32_t width() const noexcept
   {
-    set_float(GX_FLOAT_EXPOSURE_TIME, value);
+    return width_;
   }
 
-  double exposure_time() const
+  /// @returns The height of frames.
+  std::uint32_t height() const noexcept
   {
-    return get_float(GX_FLOAT_EXPOSURE_TIME);
+    return height_;
   }
 
-  std::pair<double, double> exposure_time_range() const
+  /// @returns The number of significant bits of samples.
+  unsigned significant_bits() const noexcept
   {
-    return get_float_range(GX_FLOAT_EXPOSURE_TIME);
+    return significant_bits_;
   }
 
-  bool is_exposure_delay_implemented() const
+  /// @returns The number of added frames.
+  std::size_t count() const noexcept
   {
-    return is_implemented(GX_FLOAT_EXPOSURE_DELAY);
+    return count_;
   }
 
-  void set_exposure_delay(const double value)
+  /**
+   * @returns The average frame.
+   *
+   * @par Requires
+   * `count()`.
+   */
+  std::vector<std::uint16_t> average() const
   {
-    set_float(GX_FLOAT_EXPOSURE_DELAY, value);
+    if (!count_)
+      throw std::logic_error{"no frames to average"};
+
+    std::vector<std::uint16_t> result(sums_.size());
+    for (std::size_t i{}; i < sums_.size(); ++i)
+      result[i] = static_cast<std::uint16_t>((sums_[i] + count_ / 2) / count_);
+    return result;
   }
 
-  double exposure_delay() const
+  /// Removes the added frames.
+  void clear() noexcept
   {
-    return get_float(GX_FLOAT_EXPOSURE_DELAY);
+    std::fill(sums_.begin(), sums_.end(), std::uint64_t{});
+    count_ = 0;
   }
 
-  std::pair<double, double> exposure_delay_range() const
+private:
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  unsigned significant_bits_{};
+  std::vector<std::uint64_t> sums_;
+  std::size_t count_{};
+};
+
+/**
+ * Captures `count` frames from the `device` and adds them to the averager.
+ * Incomplete frames are skipped, but no more than `3 * count` of them.
+ *
+ * @throws `std::runtime_error` if the limit of incomplete frames is exceeded.
+ *
+ * @par Requires
+ * The acquisition is started, and the pixel format of the device is an
+ * unpacked monochrome or Bayer one.
+ *
+ * @returns The averager of the frames.
+ */
+inline Frame_averager accumulate_frames(Device& device,
+  const std::size_t count, const std::chrono::milliseconds timeout)
+{
+  if (!count)
+    throw std::invalid_argument{"invalid number of frames to average"};
+
+  Frame_data frame;
+  std::optional<Frame_averager> averager;
+  const auto max_attempts = 4 * count;
+  for (std::size_t attempts{}; !averager || averager->count() < count; ++attempts) {
+    if (attempts == max_attempts)
+      throw std::runtime_error{"too many incomplete frames while averaging"};
+
+    device.capture(frame, timeout);
+    const auto& d = frame.data;
+    if (d.nStatus != GX_FRAME_STATUS_SUCCESS)
+      continue;
+
+    const auto width = static_cast<std::uint32_t>(d.nWidth);
+    const auto height = static_cast<std::uint32_t>(d.nHeight);
+    if (!averager) {
+      const auto info = pixel_format_info(static_cast<GX_PIXEL_FORMAT_ENTRY>(d.nPixelFormat));
+      if (info.is_packed || info.is_color() || !info.is_known)
+        throw std::runtime_error{"the format is not supported"};
+      averager.emplace(width, height, info.significant_bits);
+    } else if (width != averager->width() || height != averager->height())
+      throw std::runtime_error{"the frame size changed while averaging"};
+    averager->add(d.pImgBuf);
+  }
+  return std::move(*averager);
+}
+
+/**
+ * Captures `count` frames from the `device` and averages them (to build the
+ * dark and flat calibration frames of Flat_field_correction).
+ *
+ * @returns The average frame.
+ *
+ * @see accumulate_frames().
+ */
+inline std::vector<std::uint16_t> average_frames(Device& device,
+  const std::size_t count, const std::chrono::milliseconds timeout)
+{
+  return accumulate_frames(device, count, timeout).average();
+}
+
+// -----------------------------------------------------------------------------
+// Defective pixels
+// -----------------------------------------------------------------------------
+
+/// The options of detection of defective pixels.
+struct Defect_detection_options final {
+  /**
+   * The pixel is hot if its dark level exceeds the mean by this number of
+   * standard deviations.
+   */
+  double hot_sigma{6};
+  /**
+   * The pixel is dead if its bright level is below this fraction of the
+   * mean bright level of its color.
+   */
+  double dead_ratio{0.5};
+  /**
+   * The number of frames to discard after the illumination, since their
+   * exposure could be started before the light became stable.
+   */
+  std::size_t settle_frames{1};
+};
+
+/**
+ * The map of defective (hot and dead) pixels of a sensor, stored as the
+ * sorted list of indices (`y * width + x`) of the defective pixels.
+ *
+ * @remarks Thread-safe.
+ */
+class Defect_map final {
+public:
+  /// Constructs the empty map.
+  Defect_map() = default;
+
+  /**
+   * The constructor.
+   *
+   * @param bayer_layout The layout of the color filter array, or `NONE` for
+   * monochrome sensors.
+   * @param indices The indices of defective pixels in any order.
+   */
+  Defect_map(const std::uint32_t width, const std::uint32_t height,
+    const DX_PIXEL_COLOR_FILTER bayer_layout, std::vector<std::uint32_t> indices)
+    : width_{width}
+    , height_{height}
+    , bayer_layout_{bayer_layout}
+    , indices_{std::move(indices)}
   {
-    return get_float_range(GX_FLOAT_EXPOSURE_DELAY);
+    std::sort(indices_.begin(), indices_.end());
+    indices_.erase(std::unique(indices_.begin(), indices_.end()), indices_.end());
+    if (!indices_.empty() && indices_.back() >= std::uint64_t{width} * height)
+      throw std::out_of_range{"defective pixel index is out of range"};
   }
 
-  bool is_exposure_mode_implemented() const
+  /**
+   * @returns The map of defective pixels detected from the averages of dark
+   * and bright (uniformly lit, not saturated) frame sequences.
+   *
+   * @param dark The average dark frame, or empty to not detect hot pixels.
+   * @param bright The average bright frame, or empty to not detect dead
+   * pixels.
+   *
+   * @see Frame_averager, detect_defects().
+   */
+  static Defect_map detect(const std::uint32_t width, const std::uint32_t height,
+    const DX_PIXEL_COLOR_FILTER bayer_layout,
+    const std::vector<std::uint16_t>& dark,
+    const std::vector<std::uint16_t>& bright,
+    const Defect_detection_options& options = {})
   {
-    return is_implemented(GX_ENUM_EXPOSURE_MODE);
-  }
+    const std::size_t size{std::size_t{width} * height};
+    if ((!dark.empty() && dark.size() != size) || (!bright.empty() && bright.size() != size))
+      throw std::invalid_argument{"invalid size of calibration frame"};
+
+    std::vector<std::uint32_t> indices;
+    if (!dark.empty()) {
+      double sum{}, sum2{};
+      for (const double v : dark) {
+        sum += v;
+        sum2 += v * v;
+      }
+      const double mean{sum / size};
+      const double sigma{std::sqrt(std::max(0.0, sum2 / size - mean * mean))};
+      const double threshold{mean + options.hot_sigma * sigma};
+      for (std::size_t i{}; i < size; ++i) {
+        if (dark[i] > threshold)
+          indices.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
 
-  void set_exposure_mode(const GX_EXPOSURE_MODE_ENTRY value)
-  {
-    set_enum(GX_ENUM_EXPOSURE_MODE, value);
-  }
+    if (!bright.empty()) {
+      const auto color = [&](const std::size_t i)
+      {
+        return bayer_layout == NONE ? 0 :
+          static_cast<unsigned>(cfa_color(bayer_layout, i / width % 2, i % width % 2));
+      };
+      std::array<double, 3> sums{};
+      std::array<std::size_t, 3> counts{};
+      for (std::size_t i{}; i < size; ++i) {
+        sums[color(i)] += bright[i];
+        counts[color(i)]++;
+      }
+      for (std::size_t i{}; i < size; ++i) {
+        const auto c = color(i);
+        if (bright[i] < options.dead_ratio * sums[c] / counts[c])
+          indices.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
 
-  GX_EXPOSURE_MODE_ENTRY exposure_mode() const
-  {
-    return static_cast<GX_EXPOSURE_MODE_ENTRY>(get_enum(GX_ENUM_EXPOSURE_MODE));
+    return Defect_map{width, height, bayer_layout, std::move(indices)};
   }
 
-  bool is_exposure_auto_implemented() const
+  /// @returns The width of frames.
+  std::uint32_t width() const noexcept
   {
-    return is_implemented(GX_ENUM_EXPOSURE_AUTO);
+    return width_;
   }
 
-  void set_exposure_auto(const GX_EXPOSURE_AUTO_ENTRY value)
+  /// @returns The height of frames.
+  std::uint32_t height() const noexcept
   {
-    set_enum(GX_ENUM_EXPOSURE_AUTO, value);
+    return height_;
   }
 
-  GX_EXPOSURE_AUTO_ENTRY exposure_auto() const
+  /// @returns The layout of the color filter array.
+  DX_PIXEL_COLOR_FILTER bayer_layout() const noexcept
   {
-    return static_cast<GX_EXPOSURE_AUTO_ENTRY>(get_enum(GX_ENUM_EXPOSURE_AUTO));
+    return bayer_layout_;
   }
 
-  /// @}
-
-  /// @name Analog controls
-  /// @{
-
-  bool is_gain_auto_implemented() const
+  /// @returns The sorted indices of defective pixels.
+  const std::vector<std::uint32_t>& indices() const noexcept
   {
-    return is_implemented(GX_ENUM_GAIN_AUTO);
+    return indices_;
   }
 
-  void set_gain_auto(const GX_GAIN_AUTO_ENTRY value)
+  /// @returns The number of defective pixels.
+  std::size_t size() const noexcept
   {
-    set_enum(GX_ENUM_GAIN_AUTO, value);
+    return indices_.size();
   }
 
-  GX_GAIN_AUTO_ENTRY gain_auto() const
+  /// @returns `true` if the pixel is defective.
+  bool is_defective(const std::uint32_t x, const std::uint32_t y) const noexcept
   {
-    return static_cast<GX_GAIN_AUTO_ENTRY>(get_enum(GX_ENUM_GAIN_AUTO));
+    return std::binary_search(indices_.begin(), indices_.end(), y * width_ + x);
   }
 
-  bool is_gain_implemented() const
+  /**
+   * Replaces the defective pixels of the raw `frame` (of 8-bit samples if
+   * `significant_bits <= 8`, or 16-bit samples otherwise) by the average of
+   * their non-defective neighbours of the same color. The cost is
+   * proportional to the number of defective pixels.
+   *
+   * @param stride The number of bytes between rows of the `frame`. `0`
+   * means tightly packed.
+   */
+  void correct(void* const frame, const unsigned significant_bits,
+    const std::size_t stride = 0) const noexcept
   {
-    return is_implemented(GX_FLOAT_GAIN);
+    if (significant_bits > 8)
+      correct_samples(static_cast<std::uint16_t*>(frame), stride ? stride : width_ * 2);
+    else
+      correct_samples(static_cast<std::uint8_t*>(frame), stride ? stride : width_);
   }
 
-  void set_gain(const GX_GAIN_SELECTOR_ENTRY channel, const double value)
-  {
-    set_enum(GX_ENUM_GAIN_SELECTOR, channel);
-    set_float(GX_FLOAT_GAIN, value);
-  }
+private:
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  DX_PIXEL_COLOR_FILTER bayer_layout_{NONE};
+  std::vector<std::uint32_t> indices_;
 
-  double gain(const GX_GAIN_SELECTOR_ENTRY channel) const
+  template<typename T>
+  void correct_samples(T* const frame, const std::size_t stride) const noexcept
   {
-    set_enum(GX_ENUM_GAIN_SELECTOR, channel);
-    return get_float(GX_FLOAT_GAIN);
+    auto* const base = reinterpret_cast<std::uint8_t*>(frame);
+    const auto at = [base, stride](const std::uint32_t x, const std::uint32_t y) -> T&
+    {
+      return reinterpret_cast<T*>(base + y * stride)[x];
+    };
+    const bool is_bayer{bayer_layout_ != NONE};
+    // Same-color neighbours are 2 pixels apart in Bayer images.
+    const std::int64_t d{is_bayer ? 2 : 1};
+    for (const auto index : indices_) {
+      const std::uint32_t x{index % width_}, y{index / width_};
+      std::uint32_t sum{}, count{};
+      const auto add = [&](const std::int64_t dx, const std::int64_t dy)
+      {
+        const auto nx = x + dx, ny = y + dy;
+        if (nx < 0 || ny < 0 || nx >= width_ || ny >= height_)
+          return;
+        const auto ux = static_cast<std::uint32_t>(nx), uy = static_cast<std::uint32_t>(ny);
+        if (!is_defective(ux, uy)) {
+          sum += at(ux, uy);
+          count++;
+        }
+      };
+      add(-d, 0);
+      add(d, 0);
+      add(0, -d);
+      add(0, d);
+      // Green pixels have also the diagonal green neighbours.
+      if (is_bayer && cfa_color(bayer_layout_, y, x) == Cfa_color::green) {
+        add(-1, -1);
+        add(1, -1);
+        add(-1, 1);
+        add(1, 1);
+      }
+      if (count)
+        at(x, y) = static_cast<T>((sum + count / 2) / count);
+    }
   }
+};
 
-  std::pair<double, double> gain_range(const GX_GAIN_SELECTOR_ENTRY channel) const
+/**
+ * Captures the dark and bright frame sequences from the `device` and detects
+ * the defective pixels.
+ *
+ * @param count The number of frames of each sequence.
+ * @param illuminate The function which is called after the dark sequence to
+ * uniformly lit the sensor. It must return when the light is stable. The
+ * frames queued before that are flushed, and the next
+ * `options.settle_frames` frames are discarded.
+ *
+ * @par Requires
+ * The acquisition is started, the sensor is dark, and the pixel format of
+ * the device is an unpacked monochrome or Bayer one.
+ *
+ * @see accumulate_frames(), Defect_map::detect().
+ */
+inline Defect_map detect_defects(Device& device, const std::size_t count,
+  const std::chrono::milliseconds timeout, const std::function<void()>& illuminate,
+  const Defect_detection_options& options = {})
+{
+  const auto dark = accumulate_frames(device, count, timeout);
+  if (illuminate)
+    illuminate();
+  device.flush_queue();
   {
-    set_enum(GX_ENUM_GAIN_SELECTOR, channel);
-    return get_float_range(GX_FLOAT_GAIN);
+    Frame_data frame;
+    for (std::size_t i{}; i < options.settle_frames; ++i)
+      device.capture(frame, timeout);
   }
+  const auto bright = accumulate_frames(device, count, timeout);
+  if (dark.width() != bright.width() || dark.height() != bright.height())
+    throw std::runtime_error{"the frame size changed while detecting defects"};
 
-  bool is_balance_ratio_implemented() const
-  {
-    return is_implemented(GX_FLOAT_BALANCE_RATIO);
-  }
+  const auto layout = pixel_format_info(device.pixel_format()).bayer_layout;
+  return Defect_map::detect(dark.width(), dark.height(), layout, dark.average(),
+    bright.average(), options);
+}
 
-  void set_balance_ratio(const GX_BALANCE_RATIO_SELECTOR_ENTRY channel, const double value)
-  {
-    set_enum(GX_ENUM_BALANCE_RATIO_SELECTOR, channel);
-    set_float(GX_FLOAT_BALANCE_RATIO, value);
-  }
+// -----------------------------------------------------------------------------
+// Color correction
+// -----------------------------------------------------------------------------
 
-  double balance_ratio(const GX_BALANCE_RATIO_SELECTOR_ENTRY channel) const
-  {
-    set_enum(GX_ENUM_BALANCE_RATIO_SELECTOR, channel);
-    return get_float(GX_FLOAT_BALANCE_RATIO);
+/**
+ * The fixed-point coefficients of the color correction matrix.
+ *
+ * @details The coefficients of 8-bit samples are Q12 (`q12`). Since 16-bit
+ * samples need more precision, their Q28 coefficients are split into the
+ * signed `high` and the unsigned `low` 16-bit halves, and `bias` compensates
+ * the signed representation of samples (`v - 32768`) in the products with
+ * the `high` halves (plus the rounding).
+ */
+struct Color_correction_coefficients final {
+  std::int16_t q12[3][3]{};
+  std::int16_t high[3][3]{};
+  std::uint16_t low[3][3]{};
+  std::int32_t bias[3]{};
+};
+
+/// The number of fractional bits of the coefficients of 8-bit samples.
+constexpr unsigned color_correction_bits{12};
+
+/// Corrects `count` pixels of RGB24. `output` may be equal to `input`.
+inline void color_correction_u8_scalar(const std::uint8_t* const input,
+  std::uint8_t* const output, const std::size_t count,
+  const Color_correction_coefficients& k) noexcept
+{
+  constexpr std::int32_t round{1 << (color_correction_bits - 1)};
+  for (std::size_t i{}; i < count; ++i) {
+    const std::int32_t v[3]{input[3*i], input[3*i + 1], input[3*i + 2]};
+    std::uint8_t r[3];
+    for (unsigned c{}; c < 3; ++c) {
+      const auto s = (k.q12[c][0]*v[0] + k.q12[c][1]*v[1] + k.q12[c][2]*v[2] + round)
+        >> color_correction_bits;
+      r[c] = static_cast<std::uint8_t>(std::clamp(s, 0, 255));
+    }
+    std::memcpy(output + 3*i, r, sizeof(r));
   }
+}
 
-  std::pair<double, double> balance_ratio_range(const GX_BALANCE_RATIO_SELECTOR_ENTRY channel) const
-  {
-    set_enum(GX_ENUM_BALANCE_RATIO_SELECTOR, channel);
-    return get_float_range(GX_FLOAT_BALANCE_RATIO);
+/// Corrects `count` pixels of RGB48. `output` may be equal to `input`.
+inline void color_correction_u16_scalar(const std::uint16_t* const input,
+  std::uint16_t* const output, const std::size_t count,
+  const Color_correction_coefficients& k) noexcept
+{
+  for (std::size_t i{}; i < count; ++i) {
+    const std::int32_t v[3]{input[3*i], input[3*i + 1], input[3*i + 2]};
+    std::uint16_t r[3];
+    for (unsigned c{}; c < 3; ++c) {
+      // The arithmetic of color_correction_u16_sse41() exactly.
+      std::int64_t s{k.bias[c]};
+      std::uint32_t l{};
+      for (unsigned j{}; j < 3; ++j) {
+        s += std::int64_t{k.high[c][j]} * (v[j] - 32768);
+        l += (static_cast<std::uint32_t>(v[j]) * k.low[c][j] >> 16) >> 2;
+      }
+      s += std::int64_t{l} << 2;
+      r[c] = static_cast<std::uint16_t>(std::clamp<std::int64_t>(s >> color_correction_bits,
+          0, 65535));
+    }
+    std::memcpy(output + 3*i, r, sizeof(r));
   }
+}
 
-  /// @}
+#ifdef DMITIGR_GENICAM_X86
 
-  /// @name Flow layer (DataStream feature)
+/// @returns The 8 corrected 16-bit samples of the channel of the 8 pixels.
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline __m128i color_correct(const __m128i r, const __m128i g, const __m128i b,
+  const Color_correction_coefficients& k, const unsigned c) noexcept
+{
+  const auto rg = _mm_set1_epi32(static_cast<std::uint16_t>(k.q12[c][0])
+    | static_cast<std::uint32_t>(static_cast<std::uint16_t>(k.q12[c][1])) << 16);
+  const auto b1 = _mm_set1_epi32(static_cast<std::uint16_t>(k.q12[c][2])
+    | std::uint32_t{1} << (color_correction_bits - 1 + 16));
+  const auto one = _mm_set1_epi16(1);
+  const auto lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(r, g), rg),
+    _mm_madd_epi16(_mm_unpacklo_epi16(b, one), b1));
+  const auto hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(r, g), rg),
+    _mm_madd_epi16(_mm_unpackhi_epi16(b, one), b1));
+  return _mm_packs_epi32(_mm_srai_epi32(lo, color_correction_bits),
+    _mm_srai_epi32(hi, color_correction_bits));
+}
 
-  bool is_stream_transfer_size_implemented() const
-  {
-    return is_implemented(GX_DS_INT_STREAM_TRANSFER_SIZE);
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void color_correction_u8_sse41(const std::uint8_t* const input,
+  std::uint8_t* const output, const std::size_t count,
+  const Color_correction_coefficients& k) noexcept
+{
+  const auto zero = _mm_setzero_si128();
+  std::size_t i{};
+  for (; i + 16 <= count; i += 16) {
+    __m128i p[3];
+    deinterleave3<1>(input + 3*i, p);
+    const auto rl = _mm_cvtepu8_epi16(p[0]), rh = _mm_unpackhi_epi8(p[0], zero);
+    const auto gl = _mm_cvtepu8_epi16(p[1]), gh = _mm_unpackhi_epi8(p[1], zero);
+    const auto bl = _mm_cvtepu8_epi16(p[2]), bh = _mm_unpackhi_epi8(p[2], zero);
+    __m128i o[3];
+    for (unsigned c{}; c < 3; ++c)
+      o[c] = _mm_packus_epi16(color_correct(rl, gl, bl, k, c),
+        color_correct(rh, gh, bh, k, c));
+    interleave3<1>(o[0], o[1], o[2], output + 3*i);
   }
+  color_correction_u8_scalar(input + 3*i, output + 3*i, count - i, k);
+}
 
-  void set_stream_transfer_size(const std::int64_t value)
-  {
-    set_int(GX_DS_INT_STREAM_TRANSFER_SIZE, value);
-  }
+/// @returns The 8 corrected samples of the channel of the 8 pixels.
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline __m128i color_correct(const __m128i (&v)[3], const __m128i (&sv)[3],
+  const Color_correction_coefficients& k, const unsigned c) noexcept
+{
+  const auto zero = _mm_setzero_si128();
+  const auto rg = _mm_set1_epi32(static_cast<std::uint16_t>(k.high[c][0])
+    | static_cast<std::uint32_t>(static_cast<std::uint16_t>(k.high[c][1])) << 16);
+  const auto b0 = _mm_set1_epi32(static_cast<std::uint16_t>(k.high[c][2]));
+  const auto bias = _mm_set1_epi32(k.bias[c]);
+  // The products with the low halves of the coefficients (fit in 16 bits).
+  auto l = _mm_srli_epi16(_mm_mulhi_epu16(v[0], _mm_set1_epi16(static_cast<short>(k.low[c][0]))), 2);
+  l = _mm_add_epi16(l, _mm_srli_epi16(_mm_mulhi_epu16(v[1],
+        _mm_set1_epi16(static_cast<short>(k.low[c][1]))), 2));
+  l = _mm_add_epi16(l, _mm_srli_epi16(_mm_mulhi_epu16(v[2],
+        _mm_set1_epi16(static_cast<short>(k.low[c][2]))), 2));
+  const auto lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(sv[0], sv[1]), rg),
+      _mm_madd_epi16(_mm_unpacklo_epi16(sv[2], zero), b0)),
+    _mm_add_epi32(bias, _mm_slli_epi32(_mm_unpacklo_epi16(l, zero), 2)));
+  const auto hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(sv[0], sv[1]), rg),
+      _mm_madd_epi16(_mm_unpackhi_epi16(sv[2], zero), b0)),
+    _mm_add_epi32(bias, _mm_slli_epi32(_mm_unpackhi_epi16(l, zero), 2)));
+  return _mm_packus_epi32(_mm_srai_epi32(lo, color_correction_bits),
+    _mm_srai_epi32(hi, color_correction_bits));
+}
 
-  std::int64_t stream_transfer_size()
-  {
-    return get_int(GX_DS_INT_STREAM_TRANSFER_SIZE);
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void color_correction_u16_sse41(const std::uint16_t* const input,
+  std::uint16_t* const output, const std::size_t count,
+  const Color_correction_coefficients& k) noexcept
+{
+  const auto sign = _mm_set1_epi16(static_cast<short>(0x8000));
+  std::size_t i{};
+  for (; i + 8 <= count; i += 8) {
+    __m128i v[3];
+    deinterleave3<2>(reinterpret_cast<const std::uint8_t*>(input + 3*i), v);
+    const __m128i sv[3]{_mm_xor_si128(v[0], sign), _mm_xor_si128(v[1], sign),
+      _mm_xor_si128(v[2], sign)};
+    interleave3<2>(color_correct(v, sv, k, 0), color_correct(v, sv, k, 1),
+      color_correct(v, sv, k, 2), reinterpret_cast<std::uint8_t*>(output + 3*i));
   }
+  color_correction_u16_scalar(input + 3*i, output + 3*i, count - i, k);
+}
 
-  /// @}
+#define DMITIGR_GENICAM_COLOR_CORRECTION_U8 color_correction_u8_sse41
+#define DMITIGR_GENICAM_COLOR_CORRECTION_U16 color_correction_u16_sse41
+#else
+#define DMITIGR_GENICAM_COLOR_CORRECTION_U8 nullptr
+#define DMITIGR_GENICAM_COLOR_CORRECTION_U16 nullptr
+#endif
 
-  /// @name Control
-  /// @{
+/// Corrects the pixels of RGB24.
+inline const Kernel<void(const std::uint8_t*, std::uint8_t*, std::size_t,
+  const Color_correction_coefficients&)> color_correction_u8{"color_correction_u8",
+  color_correction_u8_scalar, DMITIGR_GENICAM_COLOR_CORRECTION_U8};
 
-  void register_capture_callback(GXCaptureCallBack callback, void* const data = {})
-  {
-    call(GXRegisterCaptureCallback, handle_, data, callback);
-  }
+/// Corrects the pixels of RGB48.
+inline const Kernel<void(const std::uint16_t*, std::uint16_t*, std::size_t,
+  const Color_correction_coefficients&)> color_correction_u16{"color_correction_u16",
+  color_correction_u16_scalar, DMITIGR_GENICAM_COLOR_CORRECTION_U16};
 
-  void unregister_capture_callback()
+#undef DMITIGR_GENICAM_COLOR_CORRECTION_U8
+#undef DMITIGR_GENICAM_COLOR_CORRECTION_U16
+
+/**
+ * The 3x3 color correction matrix applied to RGB24 or RGB48 images in fixed
+ * point: `out[c] = sum(m[c][j] * in[j])`, rounded and saturated. The results
+ * are within 1 LSB of the floating-point computation.
+ *
+ * @remarks To correct BGR images reverse both the rows and the columns of
+ * the matrix.
+ *
+ * @remarks Thread-safe.
+ */
+class Color_correction_matrix final {
+public:
+  /// The matrix (the rows correspond to the output channels).
+  using Matrix = std::array<std::array<double, 3>, 3>;
+
+  /// Constructs the identity matrix.
+  Color_correction_matrix()
+    : Color_correction_matrix{Matrix{{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}}
+  {}
+
+  /**
+   * The constructor.
+   *
+   * @par Requires
+   * The sum of absolute values of each row of `matrix` is less than `7.99`
+   * (so the fixed-point sums of RGB48 never overflow).
+   */
+  explicit Color_correction_matrix(const Matrix& matrix)
+    : matrix_{matrix}
   {
-    call(GXUnregisterCaptureCallback, handle_);
+    for (unsigned c{}; c < 3; ++c) {
+      double sum{};
+      std::int64_t high_sum{};
+      for (unsigned j{}; j < 3; ++j) {
+        const auto m = matrix[c][j];
+        if (!std::isfinite(m))
+          throw std::invalid_argument{"invalid color correction matrix"};
+        sum += std::abs(m);
+        coefficients_.q12[c][j] = static_cast<std::int16_t>(
+          std::lround(std::clamp(m * (1 << color_correction_bits), -32768., 32767.)));
+        const auto q28 = std::llround(std::ldexp(m, 28));
+        const auto high = q28 >> 16; // floor
+        coefficients_.high[c][j] = static_cast<std::int16_t>(high);
+        coefficients_.low[c][j] = static_cast<std::uint16_t>(q28 - high * 65536);
+        high_sum += high;
+      }
+      if (!(sum < 7.99))
+        throw std::invalid_argument{"invalid color correction matrix"};
+      coefficients_.bias[c] = static_cast<std::int32_t>(32768 * high_sum
+        + (1 << (color_correction_bits - 1)));
+    }
   }
 
-  void set_capture_callback(GXCaptureCallBack callback, void* const data = {})
+  /// @returns The matrix.
+  const Matrix& matrix() const noexcept
   {
-    GXUnregisterCaptureCallback(handle_);
-    register_capture_callback(callback, data);
+    return matrix_;
   }
 
-  void start_acquisition()
+  /// @returns The fixed-point coefficients.
+  const Color_correction_coefficients& coefficients() const noexcept
   {
-    call(GXStreamOn, handle_);
+    return coefficients_;
   }
 
-  void stop_acquisition()
+  /**
+   * Corrects the RGB24 image.
+   *
+   * @param output The buffer of the corrected image. May be equal to `input`
+   * (in place) if the strides are equal.
+   * @param input_stride The number of bytes between rows of the `input`. `0`
+   * means tightly packed.
+   * @param output_stride The number of bytes between rows of the `output`. `0`
+   * means tightly packed.
+   */
+  void operator()(const std::uint8_t* const input, std::uint8_t* const output,
+    const std::uint32_t width, const std::uint32_t height,
+    std::size_t input_stride = 0, std::size_t output_stride = 0) const
   {
-    call(GXStreamOff, handle_);
+    if (!input_stride)
+      input_stride = std::size_t{width} * 3;
+    if (!output_stride)
+      output_stride = std::size_t{width} * 3;
+    const auto kernel = color_correction_u8.selected();
+    for (std::uint32_t y{}; y < height; ++y)
+      kernel(input + y * input_stride, output + y * output_stride, width, coefficients_);
   }
 
-  Frame_data capture(const std::chrono::milliseconds timeout)
+  /**
+   * Corrects the RGB48 image.
+   *
+   * @param input_stride The number of bytes between rows of the `input`. `0`
+   * means tightly packed.
+   * @param output_stride The number of bytes between rows of the `output`. `0`
+   * means tightly packed.
+   *
+   * @par Requires
+   * The strides are even.
+   *
+   * @overload
+   */
+  void operator()(const std::uint16_t* const input, std::uint16_t* const output,
+    const std::uint32_t width, const std::uint32_t height,
+    std::size_t input_stride = 0, std::size_t output_stride = 0) const
   {
-    Frame_data result;
-    result.data.pImgBuf = std::malloc(static_cast<std::size_t>(payload_size()));
-    call(GXGetImage, handle_, &result.data, static_cast<std::int32_t>(timeout.count()));
-    return result;
+    if (!input_stride)
+      input_stride = std::size_t{width} * 6;
+    if (!output_stride)
+      output_stride = std::size_t{width} * 6;
+    if (input_stride % 2 || output_stride % 2)
+      throw std::invalid_argument{"invalid image stride"};
+    const auto kernel = color_correction_u16.selected();
+    const auto* const in = reinterpret_cast<const std::uint8_t*>(input);
+    auto* const out = reinterpret_cast<std::uint8_t*>(output);
+    for (std::uint32_t y{}; y < height; ++y)
+      kernel(reinterpret_cast<const std::uint16_t*>(in + y * input_stride),
+        reinterpret_cast<std::uint16_t*>(out + y * output_stride), width, coefficients_);
   }
 
-  void trigger_capture()
-  {
-    call(GXSendCommand, handle_, GX_COMMAND_TRIGGER_SOFTWARE);
+private:
+  Matrix matrix_{};
+  Color_correction_coefficients coefficients_;
+};
+
+// -----------------------------------------------------------------------------
+// Motion gate
+// -----------------------------------------------------------------------------
+
+/// The size (in samples) of the blocks compared by the motion gate.
+constexpr unsigned motion_block_size{16};
+
+/**
+ * Computes the sums of absolute differences of `count` blocks of the `row`
+ * (located every `step` samples) and the consecutive blocks of `reference`.
+ */
+inline void block_sad_scalar(const std::uint8_t* const row, const std::size_t count,
+  const std::size_t step, const std::uint8_t* const reference,
+  std::uint16_t* const sads) noexcept
+{
+  for (std::size_t b{}; b < count; ++b) {
+    const auto* const s = row + b * step;
+    const auto* const r = reference + b * motion_block_size;
+    unsigned sad{};
+    for (unsigned i{}; i < motion_block_size; ++i)
+      sad += s[i] > r[i] ? s[i] - r[i] : r[i] - s[i];
+    sads[b] = static_cast<std::uint16_t>(sad);
   }
+}
 
-  void flush_queue()
-  {
-    call(GXFlushQueue, handle_);
+#ifdef DMITIGR_GENICAM_X86
+
+DMITIGR_GENICAM_TARGET("sse4.1")
+inline void block_sad_sse41(const std::uint8_t* const row, const std::size_t count,
+  const std::size_t step, const std::uint8_t* const reference,
+  std::uint16_t* const sads) noexcept
+{
+  for (std::size_t b{}; b < count; ++b) {
+    const auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + b * step));
+    const auto r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        reference + b * motion_block_size));
+    const auto sad = _mm_sad_epu8(s, r); // two sums of 8 bytes in 64-bit lanes
+    sads[b] = static_cast<std::uint16_t>(_mm_cvtsi128_si32(sad)
+      + _mm_extract_epi16(sad, 4));
   }
+}
 
-  /// @}
+#define DMITIGR_GENICAM_BLOCK_SAD block_sad_sse41
+#else
+#define DMITIGR_GENICAM_BLOCK_SAD nullptr
+#endif
+
+/// Computes the sums of absolute differences of the blocks of the row.
+inline const Kernel<void(const std::uint8_t*, std::size_t, std::size_t,
+  const std::uint8_t*, std::uint16_t*)> block_sad{"block_sad",
+  block_sad_scalar, DMITIGR_GENICAM_BLOCK_SAD};
+
+#undef DMITIGR_GENICAM_BLOCK_SAD
+
+/// The options of the motion gate.
+struct Motion_gate_options final {
+  /// The horizontal distance (in samples) between the compared blocks.
+  unsigned block_step{64};
+  /// The vertical distance (in rows) between the compared blocks.
+  unsigned row_step{8};
+  /// The block is changed if its mean absolute difference exceeds this value.
+  unsigned block_threshold{8};
+  /// The frame has motion if at least this fraction of blocks are changed.
+  double area_threshold{0.01};
+  /**
+   * The rate of adaptation of the reference to the frames without motion:
+   * each sample of the reference moves to the frame by `1 / 2^shift` of the
+   * difference (but at least by `1`), so slow changes of lighting are
+   * absorbed. `0` means that the reference is replaced by every frame.
+   */
+  unsigned adaptation_shift{4};
+};
 
-private:
-  GX_DEV_HANDLE handle_{};
+/// The result of the motion gate.
+struct Motion_estimate final {
+  /// The number of changed blocks.
+  std::size_t changed_blocks{};
+  /// The number of compared blocks.
+  std::size_t block_count{};
+  /// `true` if the frame has motion (and should be processed).
+  bool is_motion{};
+};
 
-  std::int64_t get_enum(const GX_FEATURE_ID feature) const
+/**
+ * The cheap detector of changes between frames to skip the processing of
+ * redundant frames of static scenes.
+ *
+ * @details The blocks of `motion_block_size` samples on a sparse grid are
+ * compared with the reference. The frame with motion replaces the reference
+ * (so the next frames are compared with the last processed one), while the
+ * frames without motion are blended into it.
+ *
+ * @remarks The frames are of 8-bit samples (raw8, Mono8 or any packed format
+ * of 8-bit channels such as RGB24, with the `width` in samples).
+ *
+ * @remarks Not thread-safe.
+ */
+class Motion_gate final {
+public:
+  /// The constructor.
+  Motion_gate(const std::uint32_t width, const std::uint32_t height,
+    const Motion_gate_options& options = {})
+    : width_{width}
+    , height_{height}
+    , options_{options}
   {
-    std::int64_t result{};
-    call(GXGetEnum, handle_, feature, &result);
-    return result;
+    if (width < motion_block_size || !height)
+      throw std::invalid_argument{"invalid frame size for motion gate"};
+    else if (options.block_step < motion_block_size || !options.row_step)
+      throw std::invalid_argument{"invalid motion gate grid"};
+    else if (options.adaptation_shift > 7)
+      throw std::invalid_argument{"invalid motion gate adaptation shift"};
+
+    blocks_per_row_ = (width - motion_block_size) / options.block_step + 1;
+    row_count_ = (height - 1) / options.row_step + 1;
+    reference_.resize(block_count() * motion_block_size);
+    sads_.resize(blocks_per_row_);
   }
 
-  void set_enum(const GX_FEATURE_ID feature, const std::int64_t value) const
+  /// @returns The width of frames.
+  std::uint32_t width() const noexcept
   {
-    call(GXSetEnum, handle_, feature, value);
+    return width_;
   }
 
-  double get_float(const GX_FEATURE_ID feature) const
+  /// @returns The height of frames.
+  std::uint32_t height() const noexcept
   {
-    double result{};
-    call(GXGetFloat, handle_, feature, &result);
-    return result;
+    return height_;
   }
 
-  void set_float(const GX_FEATURE_ID feature, const double value)
+  /// @returns The options.
+  const Motion_gate_options& options() const noexcept
   {
-    call(GXSetFloat, handle_, feature, value);
+    return options_;
   }
 
-  std::int64_t get_int(const GX_FEATURE_ID feature) const
+  /// @returns The number of compared blocks of each frame.
+  std::size_t block_count() const noexcept
   {
-    std::int64_t result{};
-    call(GXGetInt, handle_, feature, &result);
-    return result;
+    return blocks_per_row_ * row_count_;
   }
 
-  void set_int(const GX_FEATURE_ID feature, const std::int64_t value)
+  /// @returns `true` if the reference is set.
+  bool has_reference() const noexcept
   {
-    call(GXSetInt, handle_, feature, value);
+    return has_reference_;
   }
 
-  std::pair<double, double> get_float_range(const GX_FEATURE_ID feature) const
+  /// Drops the reference, so the next frame is considered as motion.
+  void reset() noexcept
   {
-    GX_FLOAT_RANGE result{};
-    call(GXGetFloatRange, handle_, feature, &result);
-    return {result.dMin, result.dMax};
+    has_reference_ = false;
   }
 
-  bool is_implemented(const GX_FEATURE_ID feature) const
+  /**
+   * Compares the `frame` with the reference and updates the reference.
+   *
+   * @param stride The number of bytes between rows of the `frame`. `0` means
+   * tightly packed.
+   *
+   * @returns The estimate, with `is_motion` set if the frame should be
+   * processed. (The first frame is always considered as motion.)
+   */
+  Motion_estimate operator()(const void* const frame, std::size_t stride = 0)
   {
-    bool result{};
-    call(GXIsImplemented, handle_, feature, &result);
+    if (!stride)
+      stride = width_;
+    const auto* const f = static_cast<const std::uint8_t*>(frame);
+    const auto row_block_bytes = blocks_per_row_ * motion_block_size;
+    Motion_estimate result;
+    result.block_count = block_count();
+    if (!has_reference_) {
+      for (std::size_t r{}; r < row_count_; ++r)
+        copy_blocks(f + r * options_.row_step * stride, reference_.data() + r * row_block_bytes);
+      has_reference_ = true;
+      result.changed_blocks = result.block_count;
+      result.is_motion = true;
+      return result;
+    }
+
+    const auto kernel = block_sad.selected();
+    const std::size_t threshold{std::size_t{options_.block_threshold} * motion_block_size};
+    for (std::size_t r{}; r < row_count_; ++r) {
+      kernel(f + r * options_.row_step * stride, blocks_per_row_, options_.block_step,
+        reference_.data() + r * row_block_bytes, sads_.data());
+      for (std::size_t b{}; b < blocks_per_row_; ++b)
+        result.changed_blocks += sads_[b] > threshold;
+    }
+    result.is_motion = result.changed_blocks > 0 &&
+      static_cast<double>(result.changed_blocks) >=
+      options_.area_threshold * static_cast<double>(result.block_count);
+
+    // Update the reference.
+    for (std::size_t r{}; r < row_count_; ++r) {
+      const auto* const row = f + r * options_.row_step * stride;
+      auto* const ref = reference_.data() + r * row_block_bytes;
+      if (result.is_motion || !options_.adaptation_shift)
+        copy_blocks(row, ref);
+      else
+        adapt_blocks(row, ref);
+    }
     return result;
   }
-};
-
-namespace img {
 
-inline void throw_if_error(const VxInt32 s)
-{
-  switch (s) {
-  case DX_OK: return;
-  case DX_PARAMETER_INVALID:
-    throw std::runtime_error{"invalid input parameter"};
-  case DX_PARAMETER_OUT_OF_BOUND:
-    throw std::runtime_error{"the parameter is out of bound"};
-  case DX_NOT_ENOUGH_SYSTEM_MEMORY:
-    throw std::bad_alloc{};
-  case DX_NOT_FIND_DEVICE:
-    throw std::runtime_error{"no device found"};
-  case DX_STATUS_NOT_SUPPORTED:
-    throw std::runtime_error{"the format is not supported"};
-  case DX_CPU_NOT_SUPPORT_ACCELERATE:
-    throw std::runtime_error{"the CPU does not support acceleration"};
-  default:
-    throw std::runtime_error{"unknown error"};
+private:
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  Motion_gate_options options_;
+  std::size_t blocks_per_row_{};
+  std::size_t row_count_{};
+  bool has_reference_{};
+  std::vector<std::uint8_t> reference_;
+  std::vector<std::uint16_t> sads_;
+
+  void copy_blocks(const std::uint8_t* const row, std::uint8_t* const reference) const noexcept
+  {
+    for (std::size_t b{}; b < blocks_per_row_; ++b)
+      std::memcpy(reference + b * motion_block_size, row + b * options_.block_step,
+        motion_block_size);
   }
-}
-
-template<typename F, typename ... Types>
-inline void call(F&& f, Types&& ... args)
-{
-  throw_if_error(f(std::forward<Types>(args)...));
-}
 
-inline std::unique_ptr<unsigned char[]> raw8_to_rgb24(
-  void* const input,
-  const std::uint32_t width,
-  const std::uint32_t height,
-  const DX_BAYER_CONVERT_TYPE conversion_type,
-  const DX_PIXEL_COLOR_FILTER bayer_layout,
-  const bool flip = false)
-{
-  std::unique_ptr<unsigned char[]> result{new unsigned char[width * height * 3]};
-  call(DxRaw8toRGB24, input, result.get(), width, height, conversion_type, bayer_layout, flip);
-  return result;
-}
+  void adapt_blocks(const std::uint8_t* const row, std::uint8_t* const reference) const noexcept
+  {
+    const unsigned shift{options_.adaptation_shift};
+    for (std::size_t b{}; b < blocks_per_row_; ++b) {
+      const auto* const s = row + b * options_.block_step;
+      auto* const r = reference + b * motion_block_size;
+      for (unsigned i{}; i < motion_block_size; ++i) {
+        if (s[i] > r[i])
+          r[i] = static_cast<std::uint8_t>(r[i] + std::max((s[i] - r[i]) >> shift, 1));
+        else if (s[i] < r[i])
+          r[i] = static_cast<std::uint8_t>(r[i] - std::max((r[i] - s[i]) >> shift, 1));
+      }
+    }
+  }
+};
 
 } // namespace img
 